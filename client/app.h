@@ -20,12 +20,18 @@
 #define TASK_H_INCLUDED
 
 #include <cstdio>
+#include <list>
+#include <map>
 #include <string>
 #include <vector>
 
 #include "common_defs.h"
 #include "app_ipc.h"
+#include "cpu_topology.h"
+#include "fs_work.h"
+#include "hw_counters.h"
 #include "procinfo.h"
+#include "slot_pool.h"
 
 // forward declarations
 // (we don't need to include the full declarations from client_types.h)
@@ -56,7 +62,7 @@ typedef int PROCESS_ID;
 /// This doesn't change over the life of the active task;
 /// thus the task can use the slot directory for temp files
 /// that aren't tracked directly.
-class ACTIVE_TASK {
+class ACTIVE_TASK: public FS_OP_OWNER {
 public:
 #ifdef _WIN32
     HANDLE pid_handle, shm_handle;
@@ -69,6 +75,9 @@ public:
     PROCESS_ID pid;
     PROCINFO procinfo;
 
+    /// CPUs and NUMA node this task is bound to; empty if it isn't bound.
+    CPU_PLACEMENT cpu_placement;
+
     int slot;   ///< subdirectory of slots/ where this runs.
     inline TASK_STATE task_state() const {
         return _task_state;
@@ -112,6 +121,17 @@ public:
     bool too_large;                 ///< Working set too large to run now.
     bool needs_shmem;               ///< Waiting for a free shared memory segment.
 
+    // Background file operations of this task (see fs_work.h)
+    int fs_ops_pending;             ///< Operations not done yet.
+    bool input_copies_done;         ///< Input files with copy_file are in the slot dir.
+    int copy_error;                 ///< First error copying an input file.
+    bool outputs_checked;           ///< Output files were checked after the exit.
+    bool output_error;              ///< An output file is missing, too big or unreadable.
+
+    /// Seconds that start() took to start the process the last time,
+    /// 0 if it wasn't started yet.
+    double launch_time;
+
     /// This task wants to do network comm.
     /// This is passed via share-memory message (app_status channel).
     int want_network;
@@ -140,6 +160,12 @@ public:
     double stats_disk;              ///< Max size of the working directory.
     int stats_checkpoint;           ///< Number of checkpoints.
 
+    // Hardware performance counters (only if enabled in cc_config.xml)
+    HW_COUNTERS hw_counters;
+    HW_COUNTS hw_last;              ///< Counter values at the last sample.
+    HW_COUNTS hw_interval;          ///< Counts during the last sampling interval.
+    HW_COUNTS hw_total;             ///< Counts over all runs of this task.
+
 #if (defined (__APPLE__) && (defined(__i386__) || defined(__x86_64__)))
     // PowerPC apps emulated on i386 Macs crash if running graphics
     int powerpc_emulated_on_i386;
@@ -154,6 +180,11 @@ public:
 
     /// Make a unique key for core/app shared memory segment.
     int get_shmem_seg_name();
+#ifndef _WIN32
+    std::string get_library_path() const;
+    int fork_process(const char* exec_name, const char* exec_path, std::list<std::string>& argv);
+    int spawn_process(const char* exec_name, const char* exec_path, std::list<std::string>& argv);
+#endif
     bool runnable() const {
         return _task_state == PROCESS_UNINITIALIZED
             || _task_state == PROCESS_EXECUTING
@@ -193,6 +224,18 @@ public:
     /// Preempt (via suspend or quit) a running task.
     int preempt(bool quit_task);
 
+    /// Assign CPUs to this task according to the host's topology.
+    void place_on_cpus();
+
+    /// Return the CPUs of this task to the pool.
+    void release_cpus();
+
+    /// Start counting hardware events of the task's processes.
+    void open_hw_counters();
+
+    /// Read the hardware counters and update the interval and total counts.
+    void sample_hw_counters();
+
     /// Resume the task if it was previously running; otherwise start it.
     int resume_or_start(bool first_time);
     void send_network_available();
@@ -226,6 +269,12 @@ public:
     /// Check if everything was initialized before.
     bool is_full_init_done() const;
 
+    /// Start copying the input files that have the copy_file flag
+    /// into the slot directory.
+    void copy_input_files();
+
+    void fs_op_done(FS_OP* op);
+
     int handle_upload_files();
     void upload_notify_app(const FILE_INFO* fip, const FILE_REF* frp);
     int copy_output_files();
@@ -258,12 +307,62 @@ private:
 };
 typedef std::vector<ACTIVE_TASK*> ACTIVE_TASK_PVEC;
 
+/// Stands in for the processes of tasks when the scheduling is simulated
+/// (see sim.C). While ACTIVE_TASK_SET::simulator is set, tasks don't
+/// start or signal processes and don't use slot directories;
+/// ACTIVE_TASK calls these functions instead.
+class TASK_SIMULATOR {
+public:
+    virtual ~TASK_SIMULATOR() {}
+
+    /// Called instead of starting the process of \a atp.
+    virtual int start(ACTIVE_TASK* atp) = 0;
+
+    virtual void suspend(ACTIVE_TASK* atp) = 0;
+    virtual void resume(ACTIVE_TASK* atp) = 0;
+
+    /// Called instead of asking the process of \a atp to exit.
+    virtual void quit(ACTIVE_TASK* atp) = 0;
+};
+
 class ACTIVE_TASK_SET {
 public:
     ACTIVE_TASK_PVEC active_tasks;
+
+    /// Keeps track of which CPUs are assigned to which task.
+    CPU_PLACER cpu_placer;
+
+    /// Number of last-level cache domains of the host.
+    int nllc_domains;
+
+    /// Size of the last-level cache of one domain, 0 if unknown.
+    double llc_size;
+
+    /// Replaces the task processes if set; only the simulator sets this.
+    TASK_SIMULATOR* simulator;
+
+    /// Slot directories of the tasks.
+    SLOT_POOL slots;
+
+    /// Time that ACTIVE_TASK::start() took to start the processes.
+    METRIC_HISTOGRAM launch_times;
+
+    ACTIVE_TASK_SET();
+
     ACTIVE_TASK* lookup_pid(int pid);
-    ACTIVE_TASK* lookup_result(const RESULT* result);
+    ACTIVE_TASK* lookup_result(const RESULT* result) const;
+
+    /// Add a task to #active_tasks.
+    void insert(ACTIVE_TASK* atp);
+
+    /// Remove a task from #active_tasks without deleting it.
+    /// Its slot is given back to #slots.
+    ACTIVE_TASK_PVEC::iterator erase(ACTIVE_TASK_PVEC::iterator it);
+
     void init();
+
+    /// Read the CPU topology and enable binding of tasks to CPUs.
+    void init_cpu_placement();
     bool poll();
 
     /// Suspend all currently running tasks.
@@ -286,7 +385,7 @@ public:
     bool check_quit_timeout_exceeded();
     bool is_slot_in_use(int slot) const;
     bool is_slot_dir_in_use(const std::string& dir) const;
-    int get_free_slot() const;
+    int get_free_slot();
     void send_heartbeats();
     void send_trickle_downs();
     void report_overdue() const;
@@ -310,6 +409,11 @@ public:
 
     void write(std::ostream& out) const;
     int parse(MIOFILE& fin);
+
+private:
+    /// The tasks in #active_tasks by result, kept up to date by
+    /// insert() and erase(); the schedulers look up tasks very often.
+    std::map<const RESULT*, ACTIVE_TASK*> result_index;
 };
 
 #endif // TASK_H_INCLUDED
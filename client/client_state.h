@@ -30,9 +30,11 @@
 #include "app.h"
 #include "client_types.h"
 #include "file_xfer.h"
+#include "fs_work.h"
 #include "gui_rpc_server.h"
 #include "gui_http.h"
 #include "hostinfo.h"
+#include "metrics.h"
 #include "net_stats.h"
 #include "prefs.h"
 #include "time_stats.h"
@@ -58,6 +60,9 @@ class PERS_FILE_XFER;
 /// CLIENT_STATE encapsulates the global variables of the core client.
 /// If you add anything here, initialize it in the constructor.
 class CLIENT_STATE {
+    /// The scheduling simulator (sim.C) calls the polling functions itself.
+    friend class SIMULATOR;
+
 public:
     std::vector<PLATFORM> platforms;
     std::vector<PROJECT*> projects;
@@ -66,15 +71,19 @@ public:
     std::vector<APP_VERSION*> app_versions;
     WORKUNIT_PVEC workunits;
     RESULT_PVEC results;
+    RESULT_STATE_LISTS results_by_state;    ///< The same results, by state.
 
     PERS_FILE_XFER_SET* pers_file_xfers;
     HTTP_OP_SET* http_ops;
     FILE_XFER_SET* file_xfers;
     ACTIVE_TASK_SET active_tasks;
+    FS_WORK_QUEUE fs_work;
     HOST_INFO host_info;
     GLOBAL_PREFS global_prefs;
     NET_STATS net_stats;
     GUI_RPC_CONN_SET gui_rpcs;
+    METRICS_SERVER metrics_server;
+    mutable CLIENT_METRICS metrics; ///< Also updated by const methods such as write_state_file().
     TIME_STATS time_stats;
     PROXY_INFO proxy_info;
     GUI_HTTP gui_http;
@@ -95,6 +104,7 @@ public:
     int cmdline_gui_rpc_port;
     std::string data_directory; ///< Path to the data directory, from the command line.
     bool requested_exit;
+    bool requested_trace_dump; ///< Write the trace events at the next opportunity.
     /// venue from project that gave us general prefs
     /// or from account manager
     char main_host_venue[256];
@@ -194,6 +204,7 @@ public:
     bool poll_slow_events();
 
     void do_io_or_sleep(double sec);
+    int dump_trace();
     bool time_to_exit() const;
     PROJECT* lookup_project(const std::string& master_url);
     APP* lookup_app(const PROJECT* project, const char* name);
@@ -210,13 +221,31 @@ public:
 
     int reset_project(PROJECT* project, bool detaching);
     bool no_gui_rpc;
+
+    /// Make the next garbage_collect() look at all results and files.
+    /// Called when:
+    /// - the client starts
+    /// - a file transfer or the verification of a file fails
+    ///   (FILE_INFO::set_status())
+    /// A full pass is also done every GARBAGE_COLLECT_PERIOD seconds.
+    void request_garbage_collection(const char* where);
 private:
+    /// Results that aren't started yet can't miss their deadline
+    /// before this time; see abort_unstarted_late_jobs().
+    double next_late_job_check;
+    bool must_collect_garbage;
+    double last_garbage_collection; ///< Time of the last full pass.
+
     int link_app(PROJECT* p, APP* app);
     int link_file_info(PROJECT* p, FILE_INFO* fip);
     int link_file_ref(PROJECT* p, FILE_REF* file_refp);
     int link_app_version(PROJECT* p, APP_VERSION* avp);
     int link_workunit(PROJECT* p, WORKUNIT* wup);
     int link_result(PROJECT* p, RESULT* rp);
+
+    /// Add a linked result to the client state.
+    void add_result(RESULT* rp);
+
     void print_summary() const;
     bool garbage_collect();
     bool garbage_collect_always();
@@ -242,9 +271,6 @@ private:
     bool must_schedule_cpus;
     bool must_check_work_fetch;
     std::vector <RESULT*> ordered_scheduled_results;
-    void assign_results_to_projects();
-    RESULT* largest_debt_project_best_result();
-    RESULT* earliest_deadline_result();
     void reset_debt_accounting();
     void adjust_debts();
     bool possibly_schedule_cpus();
@@ -315,9 +341,11 @@ private:
     /// Find latest version of app for given platform
     int latest_version(const APP* app, const std::string& platform);
 
+    void check_output_files(ACTIVE_TASK& at);
     int app_finished(ACTIVE_TASK& at);
     bool start_apps();
     bool handle_finished_apps();
+    bool finish_exited_tasks();
 public:
     ACTIVE_TASK* get_task(RESULT*);
 /// @}
@@ -332,6 +360,8 @@ public:
     bool cpu_benchmarks_done();
     void cpu_benchmarks_set_defaults();
     void print_benchmark_results();
+    bool mem_bandwidth_measured() const;
+    double llc_bandwidth() const;
 /// @}
 
 /// @name cs_cmdline.C
@@ -411,6 +441,13 @@ public:
     void write_tasks_gui(std::ostream& out) const;
 /// @}
 
+/// @name cs_metrics.C
+public:
+    /// Gather the metrics of the client, for the metrics server
+    /// and the get_metrics GUI RPC.
+    void collect_metrics(std::vector<METRIC_FAMILY>& families) const;
+/// @}
+
 /// @name cs_trickle.C
 private:
     /// Scan project dir for trickle files and convert them to XML.
@@ -504,4 +541,8 @@ void print_suspend_tasks_message(int reason);
 /// to call the polling functions
 #define POLL_INTERVAL   1.0
 
+/// garbage_collect() does a full pass at least this often (seconds),
+/// in case a change that makes records unneeded didn't ask for one
+#define GARBAGE_COLLECT_PERIOD  600
+
 #endif
@@ -33,8 +33,10 @@
 #include <string>
 
 #include "common_defs.h"
+#include "coschedule.h"
 #include "md5_file.h"
 #include "rr_sim.h"
+#include "stats_store.h"
 
 #define P_LOW 1
 #define P_MEDIUM 3
@@ -116,24 +118,29 @@ public:
     void write(std::ostream& out, bool to_server) const;
     void write_gui(std::ostream& out) const;
     int delete_file();      ///< Attempt to delete the underlying file.
+    void delete_file_async();   ///< Delete the underlying file in the background.
     const char* get_init_url(bool is_upload);
     const char* get_next_url(bool is_upload);
     const char* get_current_url(bool is_upload);
     bool is_correct_url_type(bool is_upload, const std::string& url) const;
     bool had_failure(int& failnum) const;
 
+    /// Set #status to FILE_NOT_PRESENT, FILE_PRESENT,
+    /// FILE_NOT_PRESENT_NOT_NEEDED or an error code.
+    void set_status(int val);
+
     /// Create a failure message for a failed file-xfer in XML format.
     std::string failure_message() const;
 
     int merge_info(const FILE_INFO& new_info);
     int verify_file(bool strict, bool show_errors);
-
-    /// Compress the file using zlib (gzip compression).
-    int gzip();
 };
 typedef std::vector<FILE_INFO*> FILE_INFO_PVEC;
 typedef std::set<FILE_INFO*> FILE_INFO_PSET;
 
+/// Compress a file using zlib (gzip compression), replacing it.
+int gzip_file(const std::string& path);
+
 /// Describes a connection between a file and a workunit, result, or
 /// application. In the first two cases, the app will either use open() or
 /// fopen() to access the file (in which case \ref open_name is the name it
@@ -148,6 +155,9 @@ public:
     /// If true, core client will copy the file instead of making a soft link.
     /// Works both for input and output files.
     bool copy_file;
+    /// If true, the application doesn't modify the file, so a copy made
+    /// for it may be a hard link to the file in the project directory.
+    bool read_only;
     /// If true, don't treat as an error if the file is missing when the task
     /// ends.
     bool optional;
@@ -159,20 +169,6 @@ public:
 typedef std::vector<FILE_REF> FILE_REF_VEC;
 
 
-/// Statistics at a specific day.
-struct DAILY_STATS {
-    double user_total_credit;
-    double user_expavg_credit;
-    double host_total_credit;
-    double host_expavg_credit;
-    double day;
-
-    void clear();
-    DAILY_STATS() { clear(); }
-    int parse(FILE* in);
-};
-bool operator < (const DAILY_STATS& lhs, const DAILY_STATS& rhs);
-
 class WORKUNIT {
 public:
     char name[256];
@@ -384,8 +380,26 @@ public:
     bool some_download_stalled() const;
 
     bool some_result_suspended() const;
+
+    /// Forget what runnable(), downloading() and some_result_suspended()
+    /// found. Call this when a result of this project is added, removed,
+    /// suspended, resumed or changes its state, and when the project is
+    /// suspended or resumed.
+    void work_state_changed() { work_state_valid = false; }
     /// @}
 
+private:
+    /// Scan the results of this project for runnable(), downloading()
+    /// and some_result_suspended(), unless nothing changed since the
+    /// last scan.
+    void update_work_state() const;
+
+    mutable bool work_state_valid;
+    mutable bool has_runnable_result;
+    mutable bool has_downloading_result;
+    mutable bool has_suspended_result;
+
+public:
     /// temps used in CLIENT_STATE::rr_simulation();
     RR_SIM_PROJECT_STATUS rr_sim_status;
     void set_rrsim_proc_rate(double rrs);
@@ -414,9 +428,6 @@ public:
     double wall_cpu_time_this_debt_interval;
     /// @}
 
-    /// The next result to run for this project.
-    RESULT *next_runnable_result;
-
     /// Number of results in UPLOADING state.
     /// Don't start new results if these exceeds 2*ncpus.
     int nuploading_results;
@@ -490,12 +501,17 @@ public:
     void write_state(std::ostream& out, bool gui_rpc=false) const;
 
     std::vector<DAILY_STATS> statistics; ///< Statistics of the last x days.
+    STATS_FILE stats_file;  ///< The binary file of #statistics.
     int parse_statistics(FILE* in);
     void write_statistics(std::ostream& out, bool gui_rpc=false) const;
+    void write_statistics(std::ostream& out, const std::vector<DAILY_STATS>& stats) const;
 
     /// Write the statistics file.
     int write_statistics_file() const;
 
+    /// Save #statistics after the last day changed or a day was added.
+    int update_statistics_file(size_t nexpired, bool new_day);
+
     /// Get all workunits for this project.
     WORKUNIT_PVEC get_workunits() const;
 };
@@ -533,9 +549,18 @@ public:
     APP* app;
     PROJECT* project;
     std::vector<FILE_REF> app_files;
+
+    /// Contents of the link file of each of #app_files. They are the
+    /// same for all tasks of this version, so they are made once.
+    std::vector<std::string> link_templates;
+
     int ref_cnt;
     char graphics_exec_path[512];
 
+    /// Observed resource usage of this version's tasks,
+    /// used to avoid running memory-heavy tasks together.
+    RESOURCE_PROFILE resource_profile;
+
 public:
     APP_VERSION();
     ~APP_VERSION(){}
@@ -588,6 +613,10 @@ public:
     std::string stderr_out;
     bool suspended_via_gui;
 
+    /// The task has exited and its output files are being checksummed
+    /// in the background; see CLIENT_STATE::check_output_files().
+    bool checking_output;
+
     APP* app;
     WORKUNIT* wup; ///< this may be NULL after result is finished
     PROJECT* project;
@@ -596,8 +625,17 @@ private:
     int _state;                  ///< State of this result: see lib/common_defs.h
     double received_time; ///< when we got this from server
 
+    /// @name Links in the list of results in the same state
+    /// See RESULT_STATE_LISTS.
+    /// @{
+    friend class RESULT_STATE_LISTS;
+    RESULT* state_prev;
+    RESULT* state_next;
+    bool in_state_list;
+    /// @}
+
 public:
-    RESULT(){}
+    RESULT(): state_prev(0), state_next(0), in_state_list(false) {}
     ~RESULT(){}
     void clear();
     int parse_server(MIOFILE&);
@@ -666,6 +704,42 @@ public:
 };
 typedef std::vector<RESULT*> RESULT_PVEC;
 
+/// Number of states of a result, see lib/common_defs.h.
+const int NRESULT_STATES = RESULT_ABORTED + 1;
+
+/// The results of the client, in one list per state, so that the polls
+/// that only handle results in some states don't have to look at all
+/// of them. The lists are linked through the results themselves, and
+/// RESULT::set_state() moves a result to the list of its new state.
+class RESULT_STATE_LISTS {
+public:
+    RESULT_STATE_LISTS();
+
+    /// Append a result to the list of its current state.
+    void insert(RESULT* rp);
+
+    /// Remove a result from its list.
+    void remove(RESULT* rp);
+
+    /// Move a result to the end of the list for \a state,
+    /// if it is in one of the lists.
+    void move(RESULT* rp, int state);
+
+    /// Append the results in the given state to \a out,
+    /// in the order they entered that state.
+    void get(int state, RESULT_PVEC& out) const;
+
+    size_t size(int state) const { return counts[state]; }
+
+private:
+    RESULT* heads[NRESULT_STATES];
+    RESULT* tails[NRESULT_STATES];
+    size_t counts[NRESULT_STATES];
+
+    void unlink(RESULT* rp, int state);
+    void append(RESULT* rp, int state);
+};
+
 /// Represents an always/auto/never value, possibly temporarily overridden.
 class MODE {
 private:
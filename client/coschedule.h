@@ -0,0 +1,95 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Resource profiles of app versions and the interference model used to
+/// choose which tasks run together.
+
+#ifndef COSCHEDULE_H
+#define COSCHEDULE_H
+
+/// Bytes transferred from memory for each last-level cache miss.
+#define CACHE_LINE_SIZE 64
+
+/// Tasks with at least this many LLC misses per 1000 instructions
+/// are considered sensitive to sharing the last-level cache.
+#define LLC_SENSITIVE_MPKI 1.0
+
+struct HW_COUNTS;
+
+/// Memory traffic in bytes per second implied by the LLC misses
+/// counted over \a dt seconds.
+double mem_bandwidth(const HW_COUNTS& counts, double dt);
+
+/// Observed resource usage of the tasks of an app version.
+/// All values are exponential averages over the samples.
+struct RESOURCE_PROFILE {
+    double working_set;     ///< Working set size in bytes.
+    double page_fault_rate; ///< Page faults per second.
+    double mem_bandwidth;   ///< Memory traffic in bytes per second, 0 if not counted.
+    double llc_mpki;        ///< LLC misses per 1000 instructions, 0 if not counted.
+    int nsamples;
+
+    RESOURCE_PROFILE();
+    void clear();
+
+    /// Add a sample taken from a running task.
+    void update(double working_set, double page_fault_rate, double mem_bandwidth, double llc_mpki);
+
+    /// Amount of last-level cache this app version is expected to occupy,
+    /// given the size of the cache it runs on.
+    double llc_footprint(double llc_size) const;
+};
+
+/// The resources of the host used by a set of tasks chosen to run together.
+///
+/// The host has one or more last-level cache domains, each with its own
+/// cache and a share of the memory bandwidth. A task uses the cache of
+/// the domain it runs on, so it is never charged more than one domain's
+/// cache, but the scheduler doesn't choose the domain: the budget of the
+/// mix is that of all domains together.
+class COSCHED_MIX {
+public:
+    /// \param[in] ndomains Number of last-level cache domains.
+    /// \param[in] domain_bandwidth Memory bandwidth one domain can sustain,
+    ///                             0 if unknown.
+    /// \param[in] domain_llc Size of the cache of one domain, 0 if unknown.
+    COSCHED_MIX(int ndomains, double domain_bandwidth, double domain_llc);
+
+    /// Check if a task with the given profile can be added without
+    /// exceeding the host's capacity.
+    bool fits(const RESOURCE_PROFILE& profile) const;
+
+    void add(const RESOURCE_PROFILE& profile);
+
+    double bandwidth() const {
+        return total_bandwidth;
+    }
+    double llc_load() const {
+        return total_llc;
+    }
+
+private:
+    double bandwidth_capacity;
+    double llc_capacity;
+    double domain_llc;
+    double total_bandwidth;
+    double total_llc;
+    int ntasks;
+};
+
+#endif // COSCHEDULE_H
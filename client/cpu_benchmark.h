@@ -23,8 +23,10 @@
 
 #define BM_TYPE_FP       0
 #define BM_TYPE_INT      1
+#define BM_TYPE_MEM      2
 
 int dhrystone(double& vax_mips, double& loops, double& cpu_time, double min_cpu_time);
 int whetstone(double& flops, double& cpu_time, double min_cpu_time);
+int membw(double& bytes_per_sec, double& cpu_time, double min_cpu_time);
 void benchmark_wait_to_start(int which);
 bool benchmark_time_to_stop(int which);
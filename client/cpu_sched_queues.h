@@ -0,0 +1,97 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Orderings of the runnable results used by the CPU scheduler.
+
+#ifndef CPU_SCHED_QUEUES_H
+#define CPU_SCHED_QUEUES_H
+
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+class ACTIVE_TASK_SET;
+class PROJECT;
+class RESULT;
+
+/// The runnable results in the orders in which schedule_cpus() picks
+/// them: one deadline order over all projects, and for each project
+/// the order of its own results together with a heap of the projects
+/// by anticipated debt.
+///
+/// The orders are made once per schedule_cpus(), so choosing a result
+/// for a CPU doesn't need to look at all results again.
+/// Results with RESULT::already_selected set are skipped.
+class CPU_SCHED_QUEUES {
+public:
+    CPU_SCHED_QUEUES();
+
+    /// Order the runnable results of CPU-intensive projects.
+    void init(const std::vector<PROJECT*>& projects,
+              const std::vector<RESULT*>& results,
+              ACTIVE_TASK_SET& active_tasks);
+
+    /// Return the result with the earliest deadline.
+    /// Among results with the same deadline, prefer the ones with an active
+    /// task and then the ones with the least remaining CPU time.
+    RESULT* earliest_deadline_result();
+
+    /// Among projects with a runnable result, find the project with the
+    /// greatest anticipated debt, and return its best runnable result.
+    ///
+    /// The preference order of the results of a project:
+    /// -# results with active tasks that are running
+    /// -# results with active tasks that are preempted (but have a process)
+    /// -# results with active tasks that have no process
+    /// -# results with no active task
+    ///
+    /// The anticipated debt of the project of the returned result may be
+    /// changed before the next call; those of other projects must not be.
+    RESULT* largest_debt_project_best_result();
+
+private:
+    struct PROJECT_QUEUE {
+        PROJECT* project;
+        std::vector<RESULT*> results;
+        size_t next;            ///< Index of the first result not returned yet.
+    };
+
+    /// A project in #debt_heap with its anticipated debt at the time it
+    /// was added.
+    struct DEBT_ENTRY {
+        double debt;
+        size_t index;           ///< Index in #project_queues.
+        bool operator<(const DEBT_ENTRY& other) const;
+    };
+
+    std::vector<RESULT*> edf_order;
+    size_t edf_next;
+
+    std::vector<PROJECT_QUEUE> project_queues;
+    std::priority_queue<DEBT_ENTRY> debt_heap;
+    bool debt_heap_valid;
+
+    /// Index of the project queue of the last result returned by
+    /// largest_debt_project_best_result(), which isn't in #debt_heap.
+    size_t last_project;
+
+    RESULT* next_result(PROJECT_QUEUE& queue);
+    void push_project(size_t index);
+};
+
+#endif // CPU_SCHED_QUEUES_H
@@ -55,6 +55,9 @@ bool is_statistics_file(const std::string& filename);
 /// Get the name of the statistics file for a given master URL.
 std::string get_statistics_filename(const std::string& master_url);
 
+/// Get the name of the binary statistics file for a given master URL.
+std::string get_stats_store_filename(const std::string& master_url);
+
 /// Check if a file name denotes an image file.
 bool is_image_file(std::string filename);
 
@@ -70,6 +73,7 @@ std::string get_master_filename(const PROJECT& project);
 #define PROJECTS_DIR                "projects"
 #define SLOTS_DIR                   "slots"
 #define SWITCHER_DIR                "switcher"
+#define TRASH_DIR                   "trash"
 #define STATE_FILE_NEXT             "client_state_next.xml"
 #define STATE_FILE_NAME             "client_state.xml"
 #define STATE_FILE_PREV             "client_state_prev.xml"
@@ -103,5 +107,6 @@ std::string get_master_filename(const PROJECT& project);
 #define CA_BUNDLE_FILENAME          "ca-bundle.crt"
 #define CLIENT_AUTH_FILENAME        "client_auth.xml"
 #define TASK_STATE_FILENAME         "boinc_task_state.xml"
+#define TRACE_FILENAME              "trace.json"
 
 #endif // FILE_NAMES_H
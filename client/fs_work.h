@@ -0,0 +1,188 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Worker threads for slow file operations of the client.
+///
+/// Cleaning out a slot directory, copying an input file into a slot,
+/// deleting a file or compressing an output file can take seconds or
+/// minutes for large files. The main thread submits such operations to
+/// the FS_WORK_QUEUE and goes on; worker threads do them, and the main
+/// thread is told about each finished operation through the owner of
+/// the operation, in FS_WORK_QUEUE::poll().
+///
+/// The workers only touch the paths given to them, never the client
+/// state. If the workers aren't started (on Windows, in the simulator,
+/// or if they can't be created), poll() does the operations itself.
+/// So it does with operations that have to run the switcher in sandbox
+/// mode: the main thread reaps exited children with waitpid(0, ...)
+/// and would take the switcher process from a worker waiting for it.
+
+#ifndef FS_WORK_H
+#define FS_WORK_H
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "filesys.h"
+#include "md5_file.h"
+#include "metrics.h"
+#include "mpsc_queue.h"
+
+/// Number of worker threads started by the client. Operations are
+/// mostly limited by the disk, so a few are enough.
+#define FS_WORK_THREADS 2
+
+class FDSET_GROUP;
+class FILE_INFO;
+class FS_OP_OWNER;
+
+/// A file operation done by a worker thread.
+struct FS_OP: public MPSC_NODE {
+    enum TYPE {CLEAN_DIR, COPY, DELETE, CHECKSUM, NTYPES};
+
+    TYPE type;
+    std::string path;           ///< Directory to clean out, or file to work on.
+    std::string path2;          ///< For COPY: the destination.
+    std::string keep;           ///< For CLEAN_DIR: name of a file to leave.
+    bool gzip;                  ///< For CHECKSUM: compress the file first.
+    bool allow_link;            ///< For COPY: the copy may be a hard link.
+    FS_OP_OWNER* owner;         ///< Told when the operation is done; may be NULL.
+    FILE_INFO* fip;             ///< For the owner; not used by the workers.
+
+    /// @name Set by the worker
+    /// @{
+    int retval;
+    double duration;            ///< Seconds the operation took.
+    double nbytes;              ///< Bytes copied, or size of the checksummed file.
+    char md5[MD5_LEN];          ///< For CHECKSUM.
+    STAGE_METHOD method;        ///< For COPY: how the copy was made.
+    /// @}
+
+    FS_OP(TYPE type, const std::string& path);
+
+    /// Name of an operation type, for messages and metrics.
+    static const char* type_name(TYPE type);
+
+    /// Return true if the operation works on a file in directory \a dir.
+    bool uses_dir(const std::string& dir) const;
+
+    /// Return true if the operation may start child processes,
+    /// so that it must be done by the main thread.
+    bool needs_main_thread() const;
+
+    /// Do the operation. Called by a worker thread.
+    void run();
+};
+
+/// Something waiting for file operations to be done.
+class FS_OP_OWNER {
+public:
+    virtual ~FS_OP_OWNER() {}
+
+    /// Called by FS_WORK_QUEUE::poll() when \a op is done.
+    /// The queue deletes \a op afterwards.
+    virtual void fs_op_done(FS_OP* op) = 0;
+};
+
+class FS_WORK_QUEUE {
+public:
+    /// Counters of the operations of one type.
+    struct STATS {
+        double count;
+        double errors;
+        double nbytes;
+        METRIC_HISTOGRAM time;
+
+        STATS(): count(0), errors(0), nbytes(0) {}
+    };
+
+    FS_WORK_QUEUE();
+    ~FS_WORK_QUEUE();
+
+    /// Start \a nthreads worker threads.
+    int start(int nthreads);
+
+    /// Do all submitted operations, stop the workers
+    /// and tell the owners of the operations.
+    void finish();
+
+    /// Queue an operation. The queue owns \a op from now on.
+    void submit(FS_OP* op);
+
+    /// Forget the owner of all operations submitted by \a owner.
+    /// Operations that haven't started yet are dropped.
+    void cancel(const FS_OP_OWNER* owner);
+
+    /// Return true if an operation that isn't done works in directory \a dir.
+    bool uses_dir(const std::string& dir) const;
+
+    /// Number of operations submitted but not done.
+    size_t pending() const {
+        return outstanding.size();
+    }
+
+    /// Add the descriptor that becomes readable when an operation is done.
+    void get_fdset(FDSET_GROUP& fds);
+
+    /// Return true if an operation was done while waiting in select().
+    bool got_select(FDSET_GROUP& fds);
+
+    /// Tell the owners of the finished operations. First do the
+    /// operations that aren't for the workers. Return true if any were done.
+    bool poll();
+
+    STATS stats[FS_OP::NTYPES];
+
+private:
+    /// Operations submitted and not done yet; only used by the main thread.
+    std::set<FS_OP*> outstanding;
+
+    /// Finished operations, pushed by the workers.
+    MPSC_QUEUE<FS_OP> done;
+
+    /// Operations not started yet; protected by #mutex while the
+    /// workers run.
+    std::deque<FS_OP*> todo;
+
+    /// Operations that poll() does itself: all of them if the workers
+    /// aren't started, else those that need the main thread.
+    std::deque<FS_OP*> main_todo;
+
+    bool started;
+#ifndef _WIN32
+    bool quitting;              ///< Protected by #mutex.
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    std::vector<pthread_t> threads;
+    int done_pipe[2];           ///< Wakes up the main thread.
+
+    static void* thread_main(void* arg);
+    void run();
+#endif
+
+    void stop();
+    void complete(FS_OP* op);
+};
+
+#endif // FS_WORK_H
@@ -43,11 +43,15 @@ public:
 private:
     std::string nonce;
     std::string write_buffer;
+    std::string request_buffer; ///< Start of a request not completely received yet.
+    std::string reply_encoding; ///< Agreed on in exchange_versions, see gui_rpc_encoding.h.
 
     GET_PROJECT_CONFIG_OP get_project_config_op;
     LOOKUP_ACCOUNT_OP lookup_account_op;
     CREATE_ACCOUNT_OP create_account_op;
 
+    int handle_request(char* request_msg);
+
     /// Handle an authorization request by creating and sending a nonce.
     void handle_auth1(std::ostream& out);
 
@@ -65,6 +69,8 @@ private:
 // authentication for GUI RPCs:
 // 1) if a IPaddr-list file is found, accept only from those addrs
 // 2) if a password file file is found, ALSO demand password auth
+// 3) connections to the Unix domain socket skip the password if the peer
+//    runs as the same user as the client (see unix_peer_trusted())
 
 class GUI_RPC_CONN_SET {
     std::vector<GUI_RPC_CONN*> gui_rpcs;
@@ -74,8 +80,13 @@ class GUI_RPC_CONN_SET {
     int insert(GUI_RPC_CONN* rpc_conn);
     bool check_allowed_list(unsigned long ip_addr) const;
     bool remote_hosts_file_exists;
+#ifndef _WIN32
+    int init_unix();
+    void accept_unix();
+#endif
 public:
     int lsock;
+    int unix_lsock; ///< Listening socket at GUI_RPC_SOCKET_FILE, or -1.
 
     GUI_RPC_CONN_SET();
     char password[256];
@@ -88,4 +99,29 @@ public:
     bool poll();
 };
 
+/// Serves the client's metrics over HTTP in the Prometheus text format.
+/// Only connections from the local host are possible, and every GET
+/// request gets the same reply.
+class METRICS_SERVER {
+public:
+    METRICS_SERVER();
+    ~METRICS_SERVER();
+    int init(int port);
+    void close();
+    void get_fdset(FDSET_GROUP& fds) const;
+    void got_select(FDSET_GROUP& fds);
+
+private:
+    struct CONN {
+        int sock;
+        std::string request;
+        std::string reply;
+        size_t sent;
+    };
+    int lsock;
+    std::vector<CONN> conns;
+
+    void handle_request(CONN& conn) const;
+};
+
 #endif
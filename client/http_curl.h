@@ -30,6 +30,7 @@
 #include "proxy_info.h"
 
 class FDSET_GROUP;
+class XFER_LINK;
 
 int curl_init();
 int curl_cleanup();
@@ -72,6 +73,7 @@ public:
     int content_length;
     double file_offset;
     int trace_id;
+    int xfer_id;            ///< Identifies the transfer in events of the network thread.
     char request_header[4096];
 
     FILE* fileIn;
@@ -80,6 +82,7 @@ public:
     struct curl_slist *pcurlList; ///< curl slist for http headers
     struct curl_httppost *pcurlFormStart; ///< a pointer to a form item for POST
     struct curl_httppost *pcurlFormEnd; ///< a pointer to a form item for POST
+    XFER_LINK* link;    ///< Passed to the libcurl callbacks instead of this.
     unsigned char* pByte;  ///< pointer to bytes for reading via libcurl_read function
 
     long lSeek; ///< offset within the file or memory buffer we're reading,
@@ -111,6 +114,15 @@ public:
     /// this includes previous count (i.e. file offset)
     double bytes_xferred;
 
+    /// Bytes_xferred as counted by the libcurl callbacks, which run in
+    /// the network thread. The main thread only sees it through the
+    /// events of that thread, which update bytes_xferred.
+    double net_bytes_xferred;
+
+    /// The handle was given to the network thread, which hasn't
+    /// reported the end of the transfer yet.
+    bool net_active;
+
     /// Bytes_xferred at the start of this operation.
     /// Used to compute transfer speed.
     double start_bytes_xferred;
@@ -137,7 +149,7 @@ public:
     void close_file();
     void update_speed();
     void set_speed_limit(bool is_upload, double bytes_sec);
-    void handle_messages(CURLMsg*);
+    void handle_messages(CURLcode result);
 
     //int init_head(const char* url);
     int init_get(const char* url, const char* outfile, bool del_old_file, double offset=0);
@@ -165,11 +177,11 @@ private:
 };
 
 /// global function used by libcurl to write http replies to disk
-size_t libcurl_write(void *ptr, size_t size, size_t nmemb, HTTP_OP* phop);
-size_t libcurl_read( void *ptr, size_t size, size_t nmemb, HTTP_OP* phop);
-curlioerr libcurl_ioctl(CURL *handle, curliocmd cmd, HTTP_OP* phop);
+size_t libcurl_write(void *ptr, size_t size, size_t nmemb, XFER_LINK* link);
+size_t libcurl_read( void *ptr, size_t size, size_t nmemb, XFER_LINK* link);
+curlioerr libcurl_ioctl(CURL *handle, curliocmd cmd, XFER_LINK* link);
 int libcurl_debugfunction(CURL *handle, curl_infotype type,
-    unsigned char *data, size_t size, HTTP_OP* phop);
+    unsigned char *data, size_t size, XFER_LINK* link);
 
 /// represents a set of HTTP requests in progress
 class HTTP_OP_SET {
@@ -183,11 +195,17 @@ public:
     double bytes_up; ///< total bytes uploaded
     double bytes_down; ///< total bytes downloaded
 
+    /// Start the thread doing the transfers; without it they are done
+    /// by got_select().
+    int start_net_thread();
+
     void get_fdset(FDSET_GROUP&);
+
+    /// Handle the events of the network thread.
     void got_select(FDSET_GROUP&, double);
 
-    /// Lookup by easycurl handle.
-    HTTP_OP* lookup_curl(CURL* pcurl);
+    /// Lookup by HTTP_OP::xfer_id.
+    HTTP_OP* lookup_xfer(int xfer_id);
 
     /// Delete all temporary files.
     void cleanup_temp_files();
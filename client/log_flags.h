@@ -70,6 +70,9 @@ struct LOG_FLAGS {
     bool mem_usage_debug;   ///< memory usage
     bool network_status_debug;
     bool checkpoint_debug;
+    bool perf_debug;        ///< hardware performance counters of tasks
+    bool fs_work_debug;     ///< background file operations
+    bool slot_debug;        ///< allocation of slot directories
 
     LOG_FLAGS();
     void defaults();
@@ -101,6 +104,11 @@ struct CONFIG {
     std::string force_auth;
     bool allow_multiple_clients;
     bool zero_debts;        ///< If true reset all debts to zero.
+    bool no_cpu_affinity;   ///< If true don't bind tasks to CPUs.
+    bool hw_counters;       ///< If true count hardware events of tasks.
+    double llc_bandwidth;   ///< Memory bandwidth in MB/sec of the CPUs sharing one last-level cache, 0 to use the benchmarks.
+    bool no_trace;          ///< If true don't record trace events.
+    int metrics_port;       ///< Local port of the metrics server, 0 for none.
 
     CONFIG();
     void defaults();
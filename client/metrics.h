@@ -0,0 +1,95 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Counters of client internals and their output in the Prometheus
+/// text format and as GUI RPC XML.
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+/// Distribution of durations, with fixed buckets from 0.5ms to 10s.
+class METRIC_HISTOGRAM {
+public:
+    METRIC_HISTOGRAM();
+
+    void observe(double seconds);
+
+    double count;
+    double sum;
+    std::vector<double> counts; ///< Per bucket, not cumulative; the last bucket is +Inf.
+
+    /// Upper bound of the given bucket.
+    static double bound(size_t bucket);
+};
+
+/// One value of a metric, e.g. <tt>synecd_results{state="uploading"} 3</tt>.
+struct METRIC_SAMPLE {
+    std::string name;   ///< Name including any suffix such as _bucket.
+    std::string labels; ///< Label set without the braces, e.g. <tt>state="new"</tt>.
+    double value;
+
+    METRIC_SAMPLE(const std::string& name, const std::string& labels, double value)
+        : name(name), labels(labels), value(value) {}
+};
+
+/// All values of one metric.
+struct METRIC_FAMILY {
+    std::string name;
+    std::string type;   ///< "counter", "gauge" or "histogram".
+    std::string help;
+    std::vector<METRIC_SAMPLE> samples;
+
+    METRIC_FAMILY(const std::string& name, const std::string& type, const std::string& help)
+        : name(name), type(type), help(help) {}
+
+    void add(double value, const std::string& labels = "");
+    void add(const METRIC_HISTOGRAM& hist, const std::string& labels = "");
+};
+
+/// Return a label set with one label, quoting the value.
+std::string metric_label(const char* name, const std::string& value);
+
+/// Counters of events inside the client, updated where they happen.
+/// Values that can be read from the client state at any time (task
+/// counts, transfer rates) aren't kept here; see
+/// CLIENT_STATE::collect_metrics().
+struct CLIENT_METRICS {
+    std::map<std::string, double> gui_rpc_calls;    ///< Keyed by request name.
+    METRIC_HISTOGRAM gui_rpc_latency;
+    METRIC_HISTOGRAM state_file_write_time;
+    double state_file_size;     ///< Size of the last state file written.
+    METRIC_HISTOGRAM main_loop_latency;
+    METRIC_HISTOGRAM network_io_time;   ///< Main thread time spent on transfers per select().
+    double file_xfer_starts;    ///< Persistent file transfer attempts.
+    double file_xfer_retries;   ///< Attempts after the first.
+    double file_xfer_backoffs;
+    double scheduler_rpc_backoffs;
+    double project_work_state_updates;  ///< Scans of the results of a project by PROJECT::runnable() and friends.
+
+    CLIENT_METRICS();
+};
+
+void write_metrics_prometheus(std::ostream& out, const std::vector<METRIC_FAMILY>& families);
+void write_metrics_xml(std::ostream& out, const std::vector<METRIC_FAMILY>& families);
+
+#endif // METRICS_H
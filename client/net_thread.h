@@ -0,0 +1,223 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Thread doing the libcurl transfers of the client.
+///
+/// The main thread owns the client state; the network thread only runs
+/// libcurl (name lookups, sockets, TLS, and the callbacks that read and
+/// write the files of the transfers). The two threads only communicate
+/// through queues of messages: the main thread sends commands (start a
+/// transfer, cancel it, limit its speed) and gets back events (progress,
+/// completion, log messages), which it handles while it has nothing
+/// else to do.
+///
+/// If the thread isn't started (on Windows, in the simulator, or if it
+/// can't be created), the calling thread does the transfers itself when
+/// it asks for events, with the same messages.
+
+#ifndef NET_THREAD_H
+#define NET_THREAD_H
+
+#include <map>
+#include <string>
+
+#include <curl/curl.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "mpsc_queue.h"
+
+class FDSET_GROUP;
+class HTTP_OP;
+
+/// The way from the libcurl callbacks of a transfer to its HTTP_OP.
+/// The network thread only uses the HTTP_OP while it holds the link;
+/// the main thread cuts the link when it cancels the transfer, so the
+/// HTTP_OP may go away before the network thread has let go of the
+/// handle.
+class XFER_LINK {
+public:
+    explicit XFER_LINK(HTTP_OP* hop);
+    ~XFER_LINK();
+
+    /// Stop the network thread from using the HTTP_OP.
+    /// Waits at most for a callback that is using it right now.
+    void cut();
+
+    /// Holds the link while the network thread uses the HTTP_OP.
+    class LOCK {
+    public:
+        explicit LOCK(XFER_LINK* link);
+        ~LOCK();
+
+        /// The HTTP_OP, or NULL if the transfer was cancelled.
+        HTTP_OP* hop() const {
+            return link->hop;
+        }
+
+    private:
+        XFER_LINK* link;
+    };
+
+private:
+    HTTP_OP* hop;
+#ifndef _WIN32
+    pthread_mutex_t mutex;
+#endif
+};
+
+/// An easy handle together with what it refers to.
+/// They are freed together once the network thread has let go of the
+/// handle.
+struct NET_HANDLE {
+    CURL* easy;
+    struct curl_slist* headers;
+    struct curl_httppost* form_start;
+    struct curl_httppost* form_end;
+    XFER_LINK* link;
+
+    NET_HANDLE();
+
+    /// Free the handle and what it refers to.
+    void release();
+};
+
+/// A request of the main thread to the network thread.
+struct NET_COMMAND: public MPSC_NODE {
+    enum TYPE {ADD, REMOVE, SPEED_LIMIT, QUIT};
+
+    TYPE type;
+    CURL* handle;
+    XFER_LINK* link;            ///< For ADD.
+    int xfer_id;                ///< For ADD.
+    double bytes_xferred;       ///< For ADD.
+    NET_HANDLE removed;         ///< For REMOVE.
+    bool is_upload;             ///< For SPEED_LIMIT.
+    double bytes_sec;           ///< For SPEED_LIMIT.
+
+    NET_COMMAND(TYPE type, CURL* handle);
+};
+
+/// A notification of the network thread to the main thread.
+struct NET_EVENT: public MPSC_NODE {
+    enum TYPE {DONE, PROGRESS, MESSAGE, REMOVED};
+
+    TYPE type;
+    int xfer_id;                ///< HTTP_OP::xfer_id of the transfer.
+    CURLcode result;            ///< For DONE.
+    double bytes_xferred;       ///< For DONE and PROGRESS.
+    std::string text;           ///< For MESSAGE.
+    NET_HANDLE removed;         ///< For REMOVED; to be released.
+
+    NET_EVENT(TYPE type, int xfer_id);
+};
+
+class NET_THREAD {
+public:
+    NET_THREAD();
+    ~NET_THREAD();
+
+    /// Create the libcurl multi handle.
+    int init();
+
+    /// Stop the thread and destroy the multi handle.
+    void cleanup();
+
+    /// Start the network thread. Must be called by the thread that
+    /// handles the events, before any transfer is added.
+    int start();
+
+    bool running() const {
+        return started;
+    }
+
+    /// @name Called by the main thread
+    /// @{
+
+    /// Start the transfer of the easy handle of \a hop.
+    int add(HTTP_OP* hop);
+
+    /// Stop a transfer and take over its handle. The link of the
+    /// handle must be cut already. Without a thread the handle is
+    /// released right away; otherwise the network thread queues a
+    /// REMOVED event once it has let go of the handle, and the handle
+    /// is released when that event is handled.
+    void remove(const NET_HANDLE& handle);
+
+    void set_speed_limit(CURL* handle, bool is_upload, double bytes_sec);
+
+    /// Add the descriptors whose activity may produce events.
+    void get_fdset(FDSET_GROUP& fds);
+
+    /// Without a thread, do the transfers that are ready, spending at
+    /// most \a timeout seconds; with one, clear the wakeup descriptor.
+    void poll(FDSET_GROUP& fds, double timeout);
+
+    /// Return the next event, or NULL. The caller deletes it, after
+    /// releasing the handle of a REMOVED event.
+    NET_EVENT* get_event() {
+        return events.pop();
+    }
+    /// @}
+
+    /// Log a message through the main thread.
+    /// Called from the libcurl callbacks.
+    void post_message(const char* format, ...)
+#ifdef __GNUC__
+        __attribute__ ((format (printf, 2, 3)))
+#endif
+    ;
+
+private:
+    /// A transfer as seen by the network thread.
+    struct TRANSFER {
+        XFER_LINK* link;
+        int xfer_id;
+        double bytes_reported;  ///< Byte count of the last PROGRESS event.
+        double report_time;
+    };
+
+    CURLM* multi;
+    MPSC_QUEUE<NET_COMMAND> commands;
+    MPSC_QUEUE<NET_EVENT> events;
+
+    /// Transfers added to the multi handle; only used by the thread
+    /// that does the transfers.
+    std::map<CURL*, TRANSFER> transfers;
+
+    bool started;
+#ifndef _WIN32
+    pthread_t thread;
+    int command_pipe[2];        ///< Wakes up the network thread.
+    int event_pipe[2];          ///< Wakes up the main thread.
+
+    static void* thread_main(void* arg);
+    void run();
+#endif
+
+    int add_transfer(CURL* handle, XFER_LINK* link, int xfer_id, double bytes_xferred);
+    void send(NET_COMMAND* cmd);
+    bool do_command(NET_COMMAND* cmd);
+    void post_event(NET_EVENT* ev);
+    void perform(double timeout);
+    void report_progress();
+};
+
+#endif // NET_THREAD_H
@@ -27,6 +27,7 @@
 #include "client_msgs.h"
 #include "client_state.h"
 #include "log_flags.h"
+#include "trace_events.h"
 
 RR_SIM_PROJECT_STATUS::RR_SIM_PROJECT_STATUS() : deadlines_missed(0), proc_rate(0), cpu_shortfall(0) {
 }
@@ -98,8 +99,8 @@ RESULT* RR_SIM_PROJECT_STATUS::get_pending() {
     if (pending.empty()) {
         return 0;
     }
-    RESULT* rp = pending[0];
-    pending.erase(pending.begin());
+    RESULT* rp = pending.front();
+    pending.pop_front();
     return rp;
 }
 
@@ -167,6 +168,7 @@ public:
 /// Deadline misses are not counted for tasks
 /// that are too large to run in RAM right now.
 void CLIENT_STATE::rr_simulation() {
+    TRACE_SCOPE trace("rr_simulation");
     double rrs = nearly_runnable_resource_share();
     double trs = total_resource_share();
     PROJECT* p, *pbest;
@@ -19,8 +19,9 @@
 #ifndef RR_SIM_H
 #define RR_SIM_H
 
-#include <vector>
 #include <cstddef>
+#include <deque>
+#include <vector>
 
 /// assume actual CPU utilization will be this multiple
 /// of what we've actually measured recently
@@ -31,7 +32,7 @@ class RESULT;
 class RR_SIM_PROJECT_STATUS {
 private:
     std::vector<RESULT*>active;     ///< jobs currently running (in simulation
-    std::vector<RESULT*>pending;    ///< jobs runnable but not running yet
+    std::deque<RESULT*>pending;     ///< jobs runnable but not running yet
     int deadlines_missed;
 
     /// Fraction of each CPU this project will get
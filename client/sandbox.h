@@ -27,7 +27,7 @@ int set_to_project_group(const char* path);
 int switcher_exec(const char* util_filename, const char* cmdline);
 
 /// Recursively delete everything in the specified directory.
-int client_clean_out_dir(const char* dirpath);
+int client_clean_out_dir(const char* dirpath, const char* keep = 0);
 
 /// Delete the file located at path.
 int delete_project_owned_file(const char* path, bool retry);
@@ -0,0 +1,172 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Emulator for the client's scheduling policies.
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app.h"
+
+class XML_PARSER;
+class PROJECT;
+class APP;
+class APP_VERSION;
+class RESULT;
+
+/// A project of the simulated host, together with its server.
+struct SIM_PROJECT {
+    /// @name Description
+    /// @{
+    std::string name;
+    double resource_share;
+    double job_rate;            ///< Jobs per hour created by the server; 0 if it never runs out.
+    double job_size;            ///< Mean CPU time of a job, in seconds.
+    double job_size_stddev;
+    double latency_bound;       ///< Time from sending a job to its deadline.
+    double checkpoint_period;   ///< CPU time between checkpoints; 0 if jobs never checkpoint.
+    double working_set;         ///< Memory used by a job, in bytes.
+    double mem_bandwidth;       ///< Memory traffic of a job running alone, in bytes/sec.
+    double llc_mpki;            ///< LLC misses per 1000 instructions of a job.
+    /// @}
+
+    /// @name State
+    /// @{
+    PROJECT* project;
+    APP* app;
+    APP_VERSION* avp;
+    int jobs_queued;            ///< Jobs the server has available.
+    double next_arrival;        ///< Time the server creates its next job.
+    int njobs;                  ///< Jobs sent so far.
+    /// @}
+
+    /// @name Statistics
+    /// @{
+    double cpu_time;            ///< CPU time used by jobs of this project.
+    double work_done;           ///< CPU time the jobs would have needed without contention.
+    int jobs_completed;
+    int deadline_misses;
+    int rpcs;
+    int rpcs_no_work;           ///< Work requests that got no jobs.
+    /// @}
+
+    SIM_PROJECT();
+    int parse(XML_PARSER& xp);
+};
+
+/// A job of the simulated host that hasn't finished yet.
+struct SIM_JOB {
+    double size;                ///< CPU time it needs without contention.
+    double done;                ///< Part of #size done so far.
+    double checkpoint;          ///< Part of #size done at the last checkpoint.
+
+    SIM_JOB(): size(0), done(0), checkpoint(0) {}
+};
+
+/// The simulated host: its hardware, preferences and projects.
+struct SIM_HOST {
+    int ncpus;
+    double p_fpops;
+    double m_nbytes;
+    int nllc_domains;           ///< Last-level cache domains.
+    double llc_size;            ///< Size of the cache of each domain.
+    double llc_bandwidth;       ///< Memory bandwidth of each domain, 0 for no limit.
+    std::vector<SIM_PROJECT> projects;
+
+    SIM_HOST();
+
+    /// Parse a host description; also sets gstate.global_prefs,
+    /// log_flags and config.
+    int parse(FILE* f);
+};
+
+/// Runs the client's scheduling code (CPU scheduling, debts and work
+/// fetch) on the simulated host, with simulated time, tasks and servers.
+class SIMULATOR: public TASK_SIMULATOR {
+public:
+    SIMULATOR(SIM_HOST& host, double delta);
+
+    /// Set up the client state for the simulated host.
+    void init();
+
+    /// Simulate the given number of seconds.
+    void run(double duration);
+
+    void print_report(FILE* f, double elapsed) const;
+
+    /// CPU time used by all jobs.
+    double get_busy_time() const {
+        return busy_time;
+    }
+
+    /// Number of tasks preempted by the CPU scheduler.
+    int get_npreemptions() const {
+        return npreemptions;
+    }
+
+    /// CPU time lost by quitting tasks after their last checkpoint.
+    double get_lost_time() const {
+        return lost_time;
+    }
+
+    virtual int start(ACTIVE_TASK* atp);
+    virtual void suspend(ACTIVE_TASK* atp);
+    virtual void resume(ACTIVE_TASK* atp);
+    virtual void quit(ACTIVE_TASK* atp);
+
+private:
+    SIM_HOST& host;
+    double delta;               ///< Simulated seconds per step.
+    double start_time;
+
+    /// The jobs that haven't finished yet;
+    /// the client only sees the estimate of their size.
+    std::map<const RESULT*, SIM_JOB> jobs;
+
+    std::map<const PROJECT*, SIM_PROJECT*> sim_projects;
+
+    /// @name Statistics
+    /// @{
+    double busy_time;           ///< CPU time used by all jobs.
+    double contention_time;     ///< CPU time lost because jobs slowed each other down.
+    double lost_time;           ///< CPU time lost by quitting tasks after their last checkpoint.
+    double late_time;           ///< CPU time of jobs that missed their deadline.
+    int nstarts;
+    int npreemptions;
+    int master_fetches;
+    int nreschedules;
+    double sched_time;          ///< Wall time spent in the CPU scheduler.
+    int nsteps;
+    double poll_time;           ///< Wall time spent in the result and garbage collection polls.
+    /// @}
+
+    void job_arrivals();
+    void contention(double& bandwidth_speed, double& llc_speed) const;
+    void advance_tasks();
+    void scheduler_rpc_poll();
+    void scheduler_rpc(SIM_PROJECT& sp);
+    void send_job(SIM_PROJECT& sp);
+    void count_unfinished();
+};
+
+#endif // SIM_H
@@ -0,0 +1,120 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Allocation of slot directories to tasks.
+///
+/// A new task needs an empty slot directory. Creating one, or cleaning
+/// out the directory of a finished task, is done ahead of time: the
+/// SLOT_POOL keeps a few empty directories ready, and the directory of a
+/// task that is gone is cleaned out by the FS_WORK_QUEUE and then goes
+/// back to the pool. Starting a task then only takes a directory from
+/// the pool.
+///
+/// The pool also keeps the mapped shared memory segment of a slot when
+/// its task is gone, so that the next task in the slot doesn't have to
+/// create and map a new one.
+
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "fs_work.h"
+
+/// Number of empty slot directories kept ready for new tasks.
+#define SLOT_POOL_SPARE 2
+
+class SLOT_POOL: public FS_OP_OWNER {
+public:
+    SLOT_POOL();
+    ~SLOT_POOL();
+
+    /// Start keeping directories ready. Existing unused directories in
+    /// slots/ are reused; those that aren't empty are cleaned out by
+    /// \a fs_work. Without this, slots have no directories (simulator).
+    void init(FS_WORK_QUEUE* fs_work);
+
+    /// Get a slot for a new task. A directory from the pool is used if
+    /// there is one; otherwise the lowest free slot whose directory is
+    /// empty or can be created.
+    int acquire();
+
+    /// Mark \a slot as used by a task that was read from the state file.
+    void take(int slot);
+
+    /// Give back the slot of a task that is gone. Its directory is
+    /// cleaned out in the background and then goes back to the pool.
+    void release(int slot);
+
+    bool in_use(int slot) const {
+        return slot >= 0 && (size_t)slot < used.size() && used[slot];
+    }
+
+    /// Take the shared memory segment kept for \a slot.
+    /// \return The mapped segment, or NULL if there is none.
+    void* get_shmem(int slot);
+
+    /// Keep the mapped shared memory segment of the task in \a slot for
+    /// the next task in the slot. Its file is left in the directory
+    /// when the directory is cleaned out.
+    void keep_shmem(int slot, void* shm);
+
+    /// Create or clean out directories until #spare are ready or
+    /// being cleaned.
+    void fill();
+
+    /// Number of empty directories ready for new tasks.
+    size_t nready() const {
+        return ready.size();
+    }
+
+    void fs_op_done(FS_OP* op);
+
+    /// Number of empty directories to keep ready.
+    size_t spare;
+
+    /// @name Statistics
+    /// @{
+    double hits;            ///< Slots taken from the pool.
+    double misses;          ///< Slots whose directory had to be made when needed.
+    /// @}
+
+private:
+    FS_WORK_QUEUE* fs_work; ///< NULL if slots have no directories.
+
+    std::vector<bool> used; ///< Slots used by tasks, by slot number.
+    std::set<int> ready;    ///< Empty directories not used by any task.
+    std::set<int> cleaning; ///< Directories being cleaned out.
+    std::set<int> broken;   ///< Directories that couldn't be cleaned out.
+    std::map<int, void*> shmem; ///< Kept shared memory segments, by slot.
+
+    /// Return the lowest slot that is neither used nor known to the pool.
+    int next_unknown(int start) const;
+
+    /// Find out whether the directory of \a slot is empty, creating it
+    /// if needed, and add it to #ready or #cleaning.
+    int prepare(int slot);
+
+    bool is_clean(int slot) const;
+    void set_used(int slot, bool value);
+    void clean(int slot);
+};
+
+#endif // SLOT_POOL_H
@@ -0,0 +1,92 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Storage of the credit statistics of a project.
+///
+/// The statistics of a project are kept in a binary file with a header
+/// and one fixed-size record per day. A scheduler reply only changes
+/// the record of the current day or adds one, so the file is updated in
+/// place instead of being written again. Days that are older than the
+/// retention window are first only marked as expired in the header; the
+/// file is compacted when enough of them have accumulated.
+///
+/// The file is read with mmap() where available. The old
+/// statistics_*.xml files are still read if there is no binary file,
+/// and still written once a day for older versions.
+
+#ifndef STATS_STORE_H
+#define STATS_STORE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Number of expired records in a statistics file that cause it to be
+/// compacted.
+#define STATS_COMPACT_SLACK 32
+
+/// Statistics at a specific day.
+struct DAILY_STATS {
+    double user_total_credit;
+    double user_expavg_credit;
+    double host_total_credit;
+    double host_expavg_credit;
+    double day;
+
+    void clear();
+    DAILY_STATS() { clear(); }
+    int parse(FILE* in);
+};
+bool operator < (const DAILY_STATS& lhs, const DAILY_STATS& rhs);
+
+/// The binary statistics file of a project.
+class STATS_FILE {
+public:
+    STATS_FILE();
+
+    /// Read the statistics file \a path.
+    ///
+    /// \param[in] path The name of the file.
+    /// \param[out] master_url The master URL of the project.
+    /// \param[out] stats The statistics that aren't expired.
+    /// \return Zero on success, ERR_FOPEN if the file can't be opened,
+    ///         ERR_FREAD if it isn't a statistics file of this computer.
+    int read(const std::string& path, std::string& master_url, std::vector<DAILY_STATS>& stats);
+
+    /// Write all of \a stats to a new file that replaces \a path.
+    int write(const std::string& path, const std::string& master_url, const std::vector<DAILY_STATS>& stats);
+
+    /// Bring the file up to date after the last day of \a stats changed
+    /// or a day was added, and \a nexpired days were removed from the
+    /// front of \a stats. Any other change makes the file be written
+    /// again.
+    int update(const std::string& path, const std::string& master_url, const std::vector<DAILY_STATS>& stats, size_t nexpired);
+
+private:
+    bool valid;         ///< The members below describe the file.
+    size_t header_size; ///< Offset of the first record.
+    size_t nrecords;    ///< Records in the file, including expired ones.
+    size_t first;       ///< Index of the first record that isn't expired.
+};
+
+/// Select at most \a max_points of the statistics between \a begin and
+/// \a end (0 for no limit), spread evenly. The first and last day of
+/// the range are always included.
+void downsample_stats(const std::vector<DAILY_STATS>& stats, double begin, double end, size_t max_points, std::vector<DAILY_STATS>& result);
+
+#endif // STATS_STORE_H
@@ -0,0 +1,141 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for client/coschedule.C
+
+#include <UnitTest++.h>
+
+#include "client/coschedule.h"
+#include "lib/hw_counters.h"
+
+namespace {
+    const double MB = 1024.0 * 1024.0;
+
+    RESOURCE_PROFILE make_profile(double working_set, double bandwidth, double mpki)
+    {
+        RESOURCE_PROFILE profile;
+        profile.update(working_set, 0, bandwidth, mpki);
+        return profile;
+    }
+}
+
+SUITE(TestCoSchedule)
+{
+    TEST(ProfileAverage)
+    {
+        RESOURCE_PROFILE profile;
+        CHECK_EQUAL(0, profile.nsamples);
+
+        profile.update(100 * MB, 10, 1000, 2.0);
+        CHECK_CLOSE(100 * MB, profile.working_set, 1.0);
+        CHECK_CLOSE(1000, profile.mem_bandwidth, 0.001);
+
+        profile.update(200 * MB, 10, 2000, 2.0);
+        CHECK_EQUAL(2, profile.nsamples);
+        CHECK(profile.working_set > 100 * MB && profile.working_set < 200 * MB);
+        CHECK(profile.mem_bandwidth > 1000 && profile.mem_bandwidth < 2000);
+        CHECK_CLOSE(2.0, profile.llc_mpki, 0.001);
+    }
+
+    /// The counts of the threads of a task, read at the end of a
+    /// 10 second interval, turned into a sample of the profile.
+    TEST(ProfileFromCounters)
+    {
+        HW_COUNTS last;
+        last.add_reading(0, 1e9, 1, 1);
+        last.add_reading(2, 1e6, 1, 1);
+        HW_COUNTS now;
+        for (int thread = 0; thread < 2; ++thread) {
+            now.add_reading(0, 2e9, 1, 1);
+            now.add_reading(2, 4e6, 1, 1);
+        }
+        HW_COUNTS interval = now - last;
+
+        RESOURCE_PROFILE profile;
+        profile.update(64 * MB, 0, mem_bandwidth(interval, 10), interval.llc_mpki());
+        CHECK_CLOSE(7e6 * CACHE_LINE_SIZE / 10, profile.mem_bandwidth, 0.001);
+        CHECK_CLOSE(7e6 / 3e9 * 1000, profile.llc_mpki, 0.001);
+        CHECK_CLOSE(8 * MB, profile.llc_footprint(8 * MB), 1.0);
+
+        CHECK_CLOSE(0, mem_bandwidth(interval, 0), 0.001);
+    }
+
+    TEST(LlcFootprint)
+    {
+        CHECK_CLOSE(0, make_profile(100 * MB, 0, 0.1).llc_footprint(8 * MB), 0.001);
+        CHECK_CLOSE(4 * MB, make_profile(4 * MB, 0, 5.0).llc_footprint(8 * MB), 1.0);
+        CHECK_CLOSE(8 * MB, make_profile(100 * MB, 0, 5.0).llc_footprint(8 * MB), 1.0);
+    }
+
+    TEST(FitsBandwidth)
+    {
+        COSCHED_MIX mix(1, 1000, 0);
+        RESOURCE_PROFILE heavy = make_profile(MB, 800, 0);
+        RESOURCE_PROFILE light = make_profile(MB, 150, 0);
+
+        // The first task always fits, even if it alone exceeds the capacity.
+        CHECK(mix.fits(make_profile(MB, 5000, 0)));
+
+        mix.add(heavy);
+        CHECK(!mix.fits(heavy));
+        CHECK(mix.fits(light));
+        mix.add(light);
+        CHECK(!mix.fits(light));
+
+        // Without a sample nothing is known about a task.
+        CHECK(mix.fits(RESOURCE_PROFILE()));
+    }
+
+    TEST(FitsLlc)
+    {
+        COSCHED_MIX mix(1, 0, 8 * MB);
+        RESOURCE_PROFILE thrashing = make_profile(6 * MB, 0, 10.0);
+        RESOURCE_PROFILE compute = make_profile(500 * MB, 0, 0.01);
+
+        mix.add(thrashing);
+        CHECK(!mix.fits(thrashing));
+        CHECK(mix.fits(compute));
+        CHECK(mix.fits(make_profile(MB, 0, 10.0)));
+        CHECK_CLOSE(6 * MB, mix.llc_load(), 1.0);
+    }
+
+    TEST(UnknownCapacity)
+    {
+        COSCHED_MIX mix(1, 0, 0);
+        RESOURCE_PROFILE heavy = make_profile(100 * MB, 1e10, 50.0);
+        mix.add(heavy);
+        CHECK(mix.fits(heavy));
+    }
+
+    /// On a host with two cache domains, a task whose working set is
+    /// larger than a domain's cache only takes that one domain's cache,
+    /// and the bandwidth of both domains is available.
+    TEST(Domains)
+    {
+        COSCHED_MIX mix(2, 1000, 8 * MB);
+        RESOURCE_PROFILE thrashing = make_profile(100 * MB, 600, 10.0);
+
+        mix.add(thrashing);
+        CHECK_CLOSE(8 * MB, mix.llc_load(), 1.0);
+        CHECK(mix.fits(thrashing));
+        mix.add(thrashing);
+        CHECK(!mix.fits(thrashing));
+        CHECK(!mix.fits(make_profile(MB, 1000, 0)));
+        CHECK(mix.fits(make_profile(MB, 500, 0)));
+    }
+}
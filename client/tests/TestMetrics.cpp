@@ -0,0 +1,119 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for client/metrics.C
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "client/metrics.h"
+
+SUITE(TestMetrics)
+{
+    TEST(HistogramBuckets)
+    {
+        METRIC_HISTOGRAM hist;
+        hist.observe(0.0002);
+        hist.observe(0.001);
+        hist.observe(0.3);
+        hist.observe(60);
+
+        CHECK_EQUAL(4.0, hist.count);
+        CHECK_CLOSE(60.3012, hist.sum, 1e-9);
+        CHECK_EQUAL(1.0, hist.counts[0]);   // <= 0.0005
+        CHECK_EQUAL(1.0, hist.counts[1]);   // <= 0.001, bounds are inclusive
+        CHECK_EQUAL(1.0, hist.counts[9]);   // <= 0.5
+        CHECK_EQUAL(1.0, hist.counts.back());   // +Inf
+    }
+
+    TEST(HistogramSamplesAreCumulative)
+    {
+        METRIC_HISTOGRAM hist;
+        hist.observe(0.0001);
+        hist.observe(0.002);
+        hist.observe(20);
+
+        METRIC_FAMILY family("latency_seconds", "histogram", "Latency.");
+        family.add(hist, metric_label("op", "x"));
+
+        CHECK_EQUAL(hist.counts.size() + 2, family.samples.size());
+        CHECK_EQUAL("latency_seconds_bucket", family.samples[0].name);
+        CHECK_EQUAL("op=\"x\",le=\"0.0005\"", family.samples[0].labels);
+        CHECK_EQUAL(1.0, family.samples[0].value);
+        CHECK_EQUAL(2.0, family.samples[2].value);  // le="0.0025"
+        CHECK_EQUAL(2.0, family.samples[hist.counts.size() - 2].value);   // le="10"
+
+        const METRIC_SAMPLE& inf = family.samples[hist.counts.size() - 1];
+        CHECK_EQUAL("op=\"x\",le=\"+Inf\"", inf.labels);
+        CHECK_EQUAL(3.0, inf.value);
+
+        CHECK_EQUAL("latency_seconds_sum", family.samples[hist.counts.size()].name);
+        CHECK_EQUAL("latency_seconds_count", family.samples.back().name);
+        CHECK_EQUAL(3.0, family.samples.back().value);
+    }
+
+    TEST(LabelEscaping)
+    {
+        CHECK_EQUAL("project=\"http://a.org/\"", metric_label("project", "http://a.org/"));
+        CHECK_EQUAL("x=\"a\\\"b\\\\c\\nd\"", metric_label("x", "a\"b\\c\nd"));
+    }
+
+    TEST(PrometheusText)
+    {
+        std::vector<METRIC_FAMILY> families;
+        METRIC_FAMILY results("synecd_results", "gauge", "Number of results by state.");
+        results.add(3, metric_label("state", "new"));
+        results.add(0.5, metric_label("state", "uploading"));
+        families.push_back(results);
+        METRIC_FAMILY total("synecd_total", "counter", "Total.");
+        total.add(1234567890);
+        families.push_back(total);
+
+        std::ostringstream out;
+        write_metrics_prometheus(out, families);
+        CHECK_EQUAL(
+            "# HELP synecd_results Number of results by state.\n"
+            "# TYPE synecd_results gauge\n"
+            "synecd_results{state=\"new\"} 3\n"
+            "synecd_results{state=\"uploading\"} 0.5\n"
+            "# HELP synecd_total Total.\n"
+            "# TYPE synecd_total counter\n"
+            "synecd_total 1234567890\n",
+            out.str()
+        );
+    }
+
+    TEST(Xml)
+    {
+        std::vector<METRIC_FAMILY> families;
+        METRIC_FAMILY results("synecd_results", "gauge", "Number of results by state.");
+        results.add(3, metric_label("state", "new"));
+        families.push_back(results);
+
+        std::ostringstream out;
+        write_metrics_xml(out, families);
+        std::string xml = out.str();
+        CHECK(xml.find("<metrics>\n<metric>\n") == 0);
+        CHECK(xml.find("<name>synecd_results</name>") != std::string::npos);
+        CHECK(xml.find("<labels>state=\"new\"</labels>") != std::string::npos);
+        CHECK(xml.find("</metric>\n</metrics>\n") != std::string::npos);
+    }
+}
@@ -0,0 +1,143 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Tests of the client's CPU scheduling, run on the simulated hosts
+/// of client/sim.C.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <UnitTest++.h>
+
+#include "client/client_state.h"
+#include "client/log_flags.h"
+#include "client/sim.h"
+#include "lib/util.h"
+
+namespace {
+    struct SIM_RESULT {
+        double busy_time;
+        double lost_time;
+        int npreemptions;
+    };
+
+    /// Simulate the host for the given number of days and collect the
+    /// statistics. The client state is global, so this is done in a
+    /// child process.
+    bool simulate(const std::string& host_xml, double days, SIM_RESULT& result)
+    {
+        memset(&result, 0, sizeof(result));
+        int fds[2];
+        if (pipe(fds)) return false;
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            close(fds[0]);
+            FILE* f = tmpfile();
+            if (!f) _exit(1);
+            fputs(host_xml.c_str(), f);
+            rewind(f);
+
+            log_flags.task = false;
+            log_flags.file_xfer = false;
+            log_flags.sched_ops = false;
+            gstate.global_prefs.defaults();
+            SIM_HOST host;
+            if (host.parse(f)) _exit(1);
+            fclose(f);
+
+            srand(1);
+            SIMULATOR sim(host, 60);
+            sim.init();
+            sim.run(days * SECONDS_PER_DAY);
+
+            SIM_RESULT r;
+            memset(&r, 0, sizeof(r));
+            r.busy_time = sim.get_busy_time();
+            r.lost_time = sim.get_lost_time();
+            r.npreemptions = sim.get_npreemptions();
+            bool ok = (write(fds[1], &r, sizeof(r)) == (ssize_t)sizeof(r));
+            _exit(ok ? 0 : 1);
+        }
+        close(fds[1]);
+        bool ok = (read(fds[0], &result, sizeof(result)) == (ssize_t)sizeof(result));
+        close(fds[0]);
+        int status;
+        waitpid(pid, &status, 0);
+        return ok && WIFEXITED(status) && !WEXITSTATUS(status);
+    }
+
+    /// The projects of sim_host_256.xml on 16 CPUs,
+    /// with two days of work queued.
+    const char* HOST_16 =
+        "<sim_host>\n"
+        "<ncpus>16</ncpus>\n"
+        "<work_buf_min_days>1</work_buf_min_days>\n"
+        "<work_buf_additional_days>1</work_buf_additional_days>\n"
+        "<project>\n"
+        "    <name>alpha</name>\n"
+        "    <resource_share>100</resource_share>\n"
+        "    <job_size>3600</job_size>\n"
+        "    <job_size_stddev>900</job_size_stddev>\n"
+        "    <latency_bound>604800</latency_bound>\n"
+        "</project>\n"
+        "<project>\n"
+        "    <name>beta</name>\n"
+        "    <resource_share>100</resource_share>\n"
+        "    <job_size>7200</job_size>\n"
+        "    <latency_bound>259200</latency_bound>\n"
+        "    <checkpoint_period>0</checkpoint_period>\n"
+        "</project>\n"
+        "<project>\n"
+        "    <name>gamma</name>\n"
+        "    <resource_share>50</resource_share>\n"
+        "    <job_size>1800</job_size>\n"
+        "    <latency_bound>172800</latency_bound>\n"
+        "</project>\n"
+        "<project>\n"
+        "    <name>delta</name>\n"
+        "    <resource_share>50</resource_share>\n"
+        "    <job_rate>20</job_rate>\n"
+        "    <job_size>14400</job_size>\n"
+        "    <latency_bound>345600</latency_bound>\n"
+        "</project>\n"
+        "</sim_host>\n";
+}
+
+SUITE(TestSim)
+{
+    /// The scheduler keeps running tasks rather than switching between
+    /// them at every reschedule. At most the tasks of the first
+    /// scheduling period are preempted once, and no CPU time is lost
+    /// by preempting tasks that can't checkpoint.
+    TEST(Preemptions)
+    {
+        SIM_RESULT result;
+        CHECK(simulate(HOST_16, 1, result));
+        CHECK(result.busy_time > 0);
+        CHECK(result.npreemptions <= 2 * 16);
+        CHECK_CLOSE(0, result.lost_time, 1.0);
+    }
+}
@@ -0,0 +1,211 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for client/stats_store.C
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "client/stats_store.h"
+#include "lib/error_numbers.h"
+#include "lib/filesys.h"
+
+namespace {
+    const char* STATS_PATH = "test_stats_store.dat";
+    const char* MASTER_URL = "http://project.example.com/";
+
+    DAILY_STATS make_day(int day, double credit) {
+        DAILY_STATS ds;
+        ds.day = 86400.0 * day;
+        ds.user_total_credit = credit;
+        ds.user_expavg_credit = credit / 2;
+        ds.host_total_credit = credit / 4;
+        ds.host_expavg_credit = credit / 8;
+        return ds;
+    }
+
+    std::vector<DAILY_STATS> make_days(int first, int n) {
+        std::vector<DAILY_STATS> stats;
+        for (int i = first; i < first + n; ++i) {
+            stats.push_back(make_day(i, 100.0 * i));
+        }
+        return stats;
+    }
+
+    bool same_stats(const std::vector<DAILY_STATS>& a, const std::vector<DAILY_STATS>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if ((a[i].day != b[i].day)
+                || (a[i].user_total_credit != b[i].user_total_credit)
+                || (a[i].user_expavg_credit != b[i].user_expavg_credit)
+                || (a[i].host_total_credit != b[i].host_total_credit)
+                || (a[i].host_expavg_credit != b[i].host_expavg_credit)
+            ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double file_size_of(const char* path) {
+        double size = 0;
+        file_size(path, size);
+        return size;
+    }
+
+    /// Deletes the statistics file at the start and end of a test.
+    struct StatsFileFixture {
+        StatsFileFixture() { boinc_delete_file(STATS_PATH); }
+        ~StatsFileFixture() { boinc_delete_file(STATS_PATH); }
+    };
+}
+
+SUITE(TestStatsStore)
+{
+    TEST_FIXTURE(StatsFileFixture, RoundTrip)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 10);
+        STATS_FILE out;
+        CHECK_EQUAL(0, out.write(STATS_PATH, MASTER_URL, stats));
+
+        STATS_FILE in;
+        std::string url;
+        std::vector<DAILY_STATS> read_back;
+        CHECK_EQUAL(0, in.read(STATS_PATH, url, read_back));
+        CHECK_EQUAL(MASTER_URL, url);
+        CHECK(same_stats(stats, read_back));
+    }
+
+    TEST_FIXTURE(StatsFileFixture, ReadErrors)
+    {
+        STATS_FILE in;
+        std::string url;
+        std::vector<DAILY_STATS> stats;
+        CHECK_EQUAL(ERR_FOPEN, in.read(STATS_PATH, url, stats));
+
+        FILE* f = fopen(STATS_PATH, "wb");
+        fputs("<daily_statistics>\n", f);
+        fclose(f);
+        CHECK_EQUAL(ERR_FREAD, in.read(STATS_PATH, url, stats));
+    }
+
+    TEST_FIXTURE(StatsFileFixture, UpdateInPlace)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 5);
+        STATS_FILE file;
+        CHECK_EQUAL(0, file.write(STATS_PATH, MASTER_URL, stats));
+        double size = file_size_of(STATS_PATH);
+
+        // Same day again: the last record is overwritten.
+        stats.back().user_total_credit += 50;
+        CHECK_EQUAL(0, file.update(STATS_PATH, MASTER_URL, stats, 0));
+        CHECK_EQUAL(size, file_size_of(STATS_PATH));
+
+        // A new day is appended.
+        stats.push_back(make_day(6, 600));
+        CHECK_EQUAL(0, file.update(STATS_PATH, MASTER_URL, stats, 0));
+        CHECK(file_size_of(STATS_PATH) > size);
+        size = file_size_of(STATS_PATH);
+
+        // Expired days stay in the file but aren't read.
+        stats.erase(stats.begin(), stats.begin() + 2);
+        stats.push_back(make_day(7, 700));
+        CHECK_EQUAL(0, file.update(STATS_PATH, MASTER_URL, stats, 2));
+        CHECK(file_size_of(STATS_PATH) > size);
+
+        STATS_FILE in;
+        std::string url;
+        std::vector<DAILY_STATS> read_back;
+        CHECK_EQUAL(0, in.read(STATS_PATH, url, read_back));
+        CHECK(same_stats(stats, read_back));
+
+        // Updating a file that was read continues where it left off.
+        stats.push_back(make_day(8, 800));
+        CHECK_EQUAL(0, in.update(STATS_PATH, MASTER_URL, stats, 0));
+        CHECK_EQUAL(0, file.read(STATS_PATH, url, read_back));
+        CHECK(same_stats(stats, read_back));
+    }
+
+    TEST_FIXTURE(StatsFileFixture, Compaction)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 10);
+        STATS_FILE file;
+        CHECK_EQUAL(0, file.write(STATS_PATH, MASTER_URL, stats));
+        double size = file_size_of(STATS_PATH);
+
+        int day = 11;
+        for (int i = 0; i <= STATS_COMPACT_SLACK; ++i, ++day) {
+            stats.erase(stats.begin());
+            stats.push_back(make_day(day, 100.0 * day));
+            CHECK_EQUAL(0, file.update(STATS_PATH, MASTER_URL, stats, 1));
+        }
+
+        // The expired days were dropped, so the file is as large as it
+        // was with the same number of days.
+        CHECK_EQUAL(size, file_size_of(STATS_PATH));
+
+        STATS_FILE in;
+        std::string url;
+        std::vector<DAILY_STATS> read_back;
+        CHECK_EQUAL(0, in.read(STATS_PATH, url, read_back));
+        CHECK(same_stats(stats, read_back));
+    }
+
+    TEST(DownsampleAll)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 10);
+        std::vector<DAILY_STATS> result;
+        downsample_stats(stats, 0, 0, 0, result);
+        CHECK(same_stats(stats, result));
+        downsample_stats(stats, 0, 0, 10, result);
+        CHECK(same_stats(stats, result));
+    }
+
+    TEST(DownsampleRange)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 10);
+        std::vector<DAILY_STATS> result;
+        downsample_stats(stats, 86400.0 * 3, 86400.0 * 6, 0, result);
+        CHECK_EQUAL(4u, result.size());
+        CHECK_EQUAL(86400.0 * 3, result.front().day);
+        CHECK_EQUAL(86400.0 * 6, result.back().day);
+
+        downsample_stats(stats, 86400.0 * 20, 0, 0, result);
+        CHECK(result.empty());
+    }
+
+    TEST(DownsampleBudget)
+    {
+        std::vector<DAILY_STATS> stats = make_days(1, 100);
+        std::vector<DAILY_STATS> result;
+        downsample_stats(stats, 0, 0, 7, result);
+        CHECK_EQUAL(7u, result.size());
+        CHECK_EQUAL(stats.front().day, result.front().day);
+        CHECK_EQUAL(stats.back().day, result.back().day);
+        for (size_t i = 1; i < result.size(); ++i) {
+            CHECK(result[i - 1].day < result[i].day);
+        }
+
+        downsample_stats(stats, 0, 0, 1, result);
+        CHECK_EQUAL(1u, result.size());
+        CHECK_EQUAL(stats.back().day, result.back().day);
+    }
+}
@@ -285,24 +285,28 @@ int CBOINCBaseView::RemoveCacheElement() {
     return -1;
 }
 
+/// Synchronize the rows whose document data changed and keep the list
+/// sorted. Only the rows that moved or changed are redrawn.
 int CBOINCBaseView::SynchronizeCache() {
     int         iRowIndex        = 0;
     int         iRowTotal        = 0;
     int         iColumnIndex     = 0;
     int         iColumnTotal     = 0;
     bool        bNeedRefreshData = false;
+    std::vector<size_t> changed;    // Cache elements whose sort key changed
 
     iRowTotal = GetDocCount();
     iColumnTotal = m_pListPane->GetColumnCount();
 
     for (iRowIndex = 0; iRowIndex < iRowTotal; iRowIndex++) {
+        if (!UpdateCacheItemStamp(m_iSortedIndexes.at(iRowIndex))) continue;
         bNeedRefreshData = false;
 
         for (iColumnIndex = 0; iColumnIndex < iColumnTotal; iColumnIndex++) {
             if (SynchronizeCacheItem(iRowIndex, iColumnIndex)) {
                 bNeedRefreshData = true;
                 if (iColumnIndex == m_iSortColumn) {
-                    m_bNeedSort = true;
+                    changed.push_back(m_iSortedIndexes[iRowIndex]);
                 }
             }
         }
@@ -315,6 +319,8 @@ int CBOINCBaseView::SynchronizeCache() {
     if (m_bNeedSort) {
         sortData();     // Will mark entire list as needing refresh
         m_bNeedSort = false;
+    } else if (!changed.empty()) {
+        sortData(changed);
     }
     return 0;
 }
@@ -323,6 +329,18 @@ bool CBOINCBaseView::SynchronizeCacheItem(wxInt32 WXUNUSED(iRowIndex), wxInt32 W
     return false;
 }
 
+/// Views whose document provides change stamps return false if the
+/// document row of a cache element didn't change since the element was
+/// last synchronized, and remember the row's stamp otherwise. By
+/// default every element is synchronized every time.
+///
+/// \param[in] iCacheIndex The index of the cache element, which is also
+///                        the index of its document row.
+/// \return True if the cache element must be synchronized.
+bool CBOINCBaseView::UpdateCacheItemStamp(size_t WXUNUSED(iCacheIndex)) {
+    return true;
+}
+
 void CBOINCBaseView::OnColClick(wxListEvent& event) {
     wxListItem      item;
     int             newSortColumn = event.GetColumn();
@@ -356,6 +374,23 @@ void CBOINCBaseView::InitSort() {
 }
 
 void CBOINCBaseView::sortData() {
+    SortRows(0);
+}
+
+/// Sort again after the sort keys of some cache elements changed.
+/// If only a few changed, they are taken out of the sorted list and
+/// inserted again where they belong, instead of sorting all rows.
+///
+/// \param[in] changed The cache elements whose sort key changed.
+void CBOINCBaseView::sortData(const std::vector<size_t>& changed) {
+    if (changed.size() * 16 > m_iSortedIndexes.size()) {
+        SortRows(0);
+    } else {
+        SortRows(&changed);
+    }
+}
+
+void CBOINCBaseView::SortRows(const std::vector<size_t>* changed) {
     if (m_iSortColumn < 0) return;
     
     typedef std::vector<size_t> size_t_vec;
@@ -374,7 +409,26 @@ void CBOINCBaseView::sortData() {
         m_pListPane->SetItemState(i, 0, wxLIST_STATE_SELECTED);
     }
     
-    std::stable_sort(m_iSortedIndexes.begin(), m_iSortedIndexes.end(), m_funcSortCompare);
+    if (changed) {
+        std::vector<bool> bChanged(n, false);
+        for (size_t j = 0; j < changed->size(); ++j) {
+            bChanged[(*changed)[j]] = true;
+        }
+        size_t k = 0;
+        for (size_t j = 0; j < n; ++j) {
+            if (!bChanged[m_iSortedIndexes[j]]) {
+                m_iSortedIndexes[k++] = m_iSortedIndexes[j];
+            }
+        }
+        m_iSortedIndexes.resize(k);
+        for (size_t j = 0; j < changed->size(); ++j) {
+            size_t_vec::iterator pos = std::upper_bound(m_iSortedIndexes.begin(),
+                m_iSortedIndexes.end(), (*changed)[j], m_funcSortCompare);
+            m_iSortedIndexes.insert(pos, (*changed)[j]);
+        }
+    } else {
+        std::stable_sort(m_iSortedIndexes.begin(), m_iSortedIndexes.end(), m_funcSortCompare);
+    }
     
     size_t_vec reverse_lookup;
     reverse_lookup.resize(m_iSortedIndexes.size());
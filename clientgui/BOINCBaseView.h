@@ -122,7 +122,12 @@ protected:
     virtual int             RemoveCacheElement();
     virtual int             SynchronizeCache();
     virtual bool            SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex);
+
+    /// Find out whether a cache element must be synchronized.
+    virtual bool            UpdateCacheItemStamp(size_t iCacheIndex);
+
     void                    sortData();
+    void                    sortData(const std::vector<size_t>& changed);
 
     virtual void            PreUpdateSelection();
     virtual void            UpdateSelection();
@@ -165,6 +170,8 @@ protected:
     bool                    m_bViewLoaded;
 
 private:
+    void                    SortRows(const std::vector<size_t>* changed);
+
     ColumnListMap m_column_keys;
 };
 
@@ -18,6 +18,9 @@
 
 #include "MainDocument.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "stdwx.h"
 
 #include "error_numbers.h"
@@ -30,6 +33,7 @@
 #include "BOINCGUIApp.h"
 #include "BOINCBaseFrame.h"
 #include "BOINCClientManager.h"
+#include "RpcThread.h"
 
 #ifndef _WIN32
 #include <sys/wait.h>
@@ -286,6 +290,13 @@ void CNetworkConnection::SetStateSuccess(const wxString& strComputer, const std:
 
         m_bConnectEvent = false;
 
+        // The refreshes are done by the RPC thread on its own connection.
+        std::string strHost;
+        if (!IsComputerNameLocal(strComputer)) {
+            strHost = (const char*)strComputer.mb_str();
+        }
+        m_pDocument->m_pRpcThread->Connect(strHost, m_iPort, strComputerPassword);
+
         pFrame->FireConnect();
     }
 }
@@ -304,6 +315,224 @@ void CNetworkConnection::SetStateDisconnected() {
 IMPLEMENT_DYNAMIC_CLASS(CMainDocument, wxObject)
 
 
+namespace {
+
+/// Redraw the views after a command changed the cached data.
+void RefreshViews() {
+    CBOINCBaseFrame* pFrame = wxGetApp().GetFrame();
+    if (pFrame) {
+        wxASSERT(wxDynamicCast(pFrame, CBOINCBaseFrame));
+        pFrame->FireRefreshView();
+    }
+}
+
+class CProjectOpCommand : public CRpcCommand {
+public:
+    CProjectOpCommand(CMainDocument* pDoc, const PROJECT& project, const char* op)
+        : m_pDoc(pDoc), m_project(project), m_op(op) {}
+
+    int Run(RPC_CLIENT& rpc) {
+        return rpc.project_op(m_project, m_op.c_str());
+    }
+
+    /// project_op() sets the flags of the project it was given;
+    /// copy them to the cached project.
+    void Done(int retval) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CProjectOpCommand::Done - Project Operation Failed '%d'"), retval);
+            return;
+        }
+        PROJECT* pProject = m_pDoc->state.lookup_project(m_project.master_url);
+        if (pProject) {
+            pProject->suspended_via_gui = m_project.suspended_via_gui;
+            pProject->dont_request_more_work = m_project.dont_request_more_work;
+        }
+        RefreshViews();
+    }
+
+private:
+    CMainDocument* m_pDoc;
+    PROJECT m_project;
+    std::string m_op;
+};
+
+class CResultOpCommand : public CRpcCommand {
+public:
+    CResultOpCommand(CMainDocument* pDoc, const RESULT& result, const char* op)
+        : m_pDoc(pDoc), m_result(result), m_op(op) {}
+
+    int Run(RPC_CLIENT& rpc) {
+        return rpc.result_op(m_result, m_op.c_str());
+    }
+
+    void Done(int retval) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CResultOpCommand::Done - Result Operation Failed '%d'"), retval);
+            return;
+        }
+        RESULT* pResult = m_pDoc->state.lookup_result(m_result.project_url, m_result.name);
+        if (pResult) {
+            pResult->suspended_via_gui = m_result.suspended_via_gui;
+        }
+        RefreshViews();
+    }
+
+private:
+    CMainDocument* m_pDoc;
+    RESULT m_result;
+    std::string m_op;
+};
+
+class CTransferOpCommand : public CRpcCommand {
+public:
+    CTransferOpCommand(const FILE_TRANSFER& ft, const char* op)
+        : m_ft(ft), m_op(op) {}
+
+    int Run(RPC_CLIENT& rpc) {
+        return rpc.file_transfer_op(m_ft, m_op.c_str());
+    }
+
+    void Done(int retval) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CTransferOpCommand::Done - File Transfer Operation Failed '%d'"), retval);
+            return;
+        }
+        RefreshViews();
+    }
+
+private:
+    FILE_TRANSFER m_ft;
+    std::string m_op;
+};
+
+/// set_run_mode or set_network_mode.
+class CRunModeCommand : public CRpcCommand {
+public:
+    CRunModeCommand(CMainDocument* pDoc, bool bNetwork, int iMode, int iTimeout)
+        : m_pDoc(pDoc), m_bNetwork(bNetwork), m_iMode(iMode), m_iTimeout(iTimeout) {}
+
+    int Run(RPC_CLIENT& rpc) {
+        if (m_bNetwork) {
+            return rpc.set_network_mode(m_iMode, m_iTimeout);
+        }
+        return rpc.set_run_mode(m_iMode, m_iTimeout);
+    }
+
+    void Done(int retval) {
+        CC_STATUS ccs;
+
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CRunModeCommand::Done - Set Mode Failed '%d'"), retval);
+            return;
+        }
+        if (RUN_MODE_RESTORE == m_iMode) {
+            m_pDoc->GetCoreClientStatus(ccs, true);
+        } else if (m_bNetwork) {
+            m_pDoc->status.network_mode = m_iMode;
+        } else {
+            m_pDoc->status.task_mode = m_iMode;
+        }
+    }
+
+private:
+    CMainDocument* m_pDoc;
+    bool m_bNetwork;
+    int m_iMode;
+    int m_iTimeout;
+};
+
+class CRunBenchmarksCommand : public CRpcCommand {
+public:
+    int Run(RPC_CLIENT& rpc) {
+        return rpc.run_benchmarks();
+    }
+};
+
+}
+
+
+/// Project, task and transfer operations collected between
+/// CMainDocument::BeginBatch() and EndBatch(), sent in one batch RPC.
+class CBatchOpCommand : public CRpcCommand {
+public:
+    CBatchOpCommand(CMainDocument* pDoc) : m_pDoc(pDoc) {}
+
+    void AddProjectOp(const PROJECT& project, const char* op) {
+        m_projects.push_back(project);
+        m_projectOps.push_back(op);
+    }
+
+    void AddResultOp(const RESULT& result, const char* op) {
+        m_results.push_back(result);
+        m_resultOps.push_back(op);
+    }
+
+    void AddTransferOp(const FILE_TRANSFER& ft, const char* op) {
+        m_transfers.push_back(ft);
+        m_transferOps.push_back(op);
+    }
+
+    bool IsEmpty() const {
+        return m_projects.empty() && m_results.empty() && m_transfers.empty();
+    }
+
+    int Run(RPC_CLIENT& rpc) {
+        RPC_BATCH batch;
+        for (size_t i = 0; i < m_projects.size(); ++i) {
+            batch.project_op(m_projects[i], m_projectOps[i].c_str());
+        }
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            batch.result_op(m_results[i], m_resultOps[i].c_str());
+        }
+        for (size_t i = 0; i < m_transfers.size(); ++i) {
+            batch.file_transfer_op(m_transfers[i], m_transferOps[i].c_str());
+        }
+        int retval = rpc.do_batch(batch);
+        m_retvals = batch.retvals;
+        return retval;
+    }
+
+    /// Like CProjectOpCommand and CResultOpCommand, copy the flags set
+    /// by the operations that succeeded to the cached state.
+    void Done(int retval) {
+        if (retval || (m_retvals.size() != m_projects.size() + m_results.size() + m_transfers.size())) {
+            wxLogTrace(wxT("Function Status"), wxT("CBatchOpCommand::Done - Batch Operation Failed '%d'"), retval);
+            return;
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < m_projects.size(); ++i, ++k) {
+            PROJECT* pProject = m_pDoc->state.lookup_project(m_projects[i].master_url);
+            if (!m_retvals[k] && pProject) {
+                pProject->suspended_via_gui = m_projects[i].suspended_via_gui;
+                pProject->dont_request_more_work = m_projects[i].dont_request_more_work;
+            }
+        }
+        for (size_t i = 0; i < m_results.size(); ++i, ++k) {
+            RESULT* pResult = m_pDoc->state.lookup_result(m_results[i].project_url, m_results[i].name);
+            if (!m_retvals[k] && pResult) {
+                pResult->suspended_via_gui = m_results[i].suspended_via_gui;
+            }
+        }
+        for (; k < m_retvals.size(); ++k) {
+            if (m_retvals[k]) {
+                wxLogTrace(wxT("Function Status"), wxT("CBatchOpCommand::Done - Operation %d Failed '%d'"), (int)k, m_retvals[k]);
+            }
+        }
+        RefreshViews();
+    }
+
+private:
+    CMainDocument* m_pDoc;
+    std::vector<PROJECT> m_projects;
+    std::vector<std::string> m_projectOps;
+    std::vector<RESULT> m_results;
+    std::vector<std::string> m_resultOps;
+    std::vector<FILE_TRANSFER> m_transfers;
+    std::vector<std::string> m_transferOps;
+    std::vector<int> m_retvals;
+};
+
+
 CMainDocument::CMainDocument() {
 
 #ifdef __WIN32__
@@ -321,6 +550,17 @@ CMainDocument::CMainDocument() {
     m_fProjectTotalResourceShare = 0.0;
 
     m_iMessageSequenceNumber = 0;
+    m_bIgnoreMessageReply = false;
+    m_bIgnoreOlderMessageReply = false;
+    m_bOlderMessages = false;
+    m_iPrependedMessages = 0;
+    m_ulLastStamp = 0;
+    m_ulStatisticsStamp = 0;
+
+    m_pNetworkConnection = NULL;
+    m_pClientManager = NULL;
+    m_pRpcThread = NULL;
+    m_pBatch = NULL;
 
     m_dtCachedStateTimestamp = wxDateTime((time_t)0);
     m_dtCachedCCStatusTimestamp = wxDateTime((time_t)0);
@@ -351,6 +591,11 @@ int CMainDocument::OnInit() {
     m_pClientManager = new CBOINCClientManager();
     wxASSERT(m_pClientManager);
 
+    m_pRpcThread = new CRpcThread();
+    if (m_pRpcThread->Start()) {
+        wxLogTrace(wxT("Function Status"), wxT("CMainDocument::OnInit - Failed to start the RPC thread"));
+    }
+
     return iRetVal;
 }
 
@@ -365,6 +610,15 @@ int CMainDocument::OnExit() {
         m_pClientManager = NULL;
     }
 
+    delete m_pBatch;
+    m_pBatch = NULL;
+
+    if (m_pRpcThread) {
+        m_pRpcThread->Stop();
+        delete m_pRpcThread;
+        m_pRpcThread = NULL;
+    }
+
     if (m_pNetworkConnection) {
         delete m_pNetworkConnection;
         m_pNetworkConnection = NULL;
@@ -401,6 +655,8 @@ int CMainDocument::OnPoll() {
     // Check connection state, connect if needed.
     m_pNetworkConnection->Poll();
 
+    ProcessRpcReplies();
+
     // Every 10 seconds, kill any running graphics apps 
     // whose associated worker tasks are no longer running
     wxTimeSpan ts(wxDateTime::Now() - m_dtKillInactiveGfxTimestamp);
@@ -413,6 +669,241 @@ int CMainDocument::OnPoll() {
 }
 
 
+namespace {
+
+/// Order messages by sequence number.
+bool message_before(const MESSAGE* a, const MESSAGE* b) {
+    return a->seqno < b->seqno;
+}
+
+/// Compare two results or file transfers by the XML they were parsed
+/// from, so that a change of any field is seen, including fields added
+/// later. Items not parsed from a reply always count as changed.
+template<class T>
+bool same_xml(const T& a, const T& b) {
+    return a.xml_hash && a.xml_hash == b.xml_hash;
+}
+
+/// Give the items of a new reply their change stamps. An item that is
+/// the same as in the old reply keeps its stamp, any other item gets a
+/// new one. Items are matched by name and project; usually they are at
+/// the same position in both replies.
+///
+/// \param[in] items The items of the new reply.
+/// \param[in] old_items The items of the old reply.
+/// \param[in,out] stamps The stamps of \a old_items, replaced by those
+///                       of \a items.
+/// \param[in,out] last The last stamp given out.
+/// \param[in] same Compares two items.
+template<class T>
+void update_stamps(const std::vector<T*>& items, const std::vector<T*>& old_items,
+    std::vector<unsigned long>& stamps, unsigned long& last,
+    bool (*same)(const T&, const T&)
+) {
+    typedef std::map<std::pair<std::string, std::string>, size_t> item_index;
+    item_index index;
+    size_t nold = std::min(old_items.size(), stamps.size());
+    std::vector<unsigned long> new_stamps(items.size(), 0);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        const T& item = *items[i];
+        size_t j = i;
+        if (j >= nold || old_items[j]->name != item.name
+            || old_items[j]->project_url != item.project_url
+        ) {
+            if (index.empty()) {
+                for (size_t k = 0; k < nold; ++k) {
+                    index[std::make_pair(old_items[k]->project_url, old_items[k]->name)] = k;
+                }
+            }
+            item_index::const_iterator it = index.find(std::make_pair(item.project_url, item.name));
+            j = (it == index.end()) ? nold : it->second;
+        }
+        if (j < nold && stamps[j] && same(item, *old_items[j])) {
+            new_stamps[i] = stamps[j];
+        } else {
+            new_stamps[i] = ++last;
+        }
+    }
+    stamps.swap(new_stamps);
+}
+
+/// Compare the statistics of two get_statistics replies.
+bool same_statistics(const std::vector<PROJECT*>& a, const std::vector<PROJECT*>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i]->master_url != b[i]->master_url) return false;
+        const std::vector<DAILY_STATS>& sa = a[i]->statistics;
+        const std::vector<DAILY_STATS>& sb = b[i]->statistics;
+        if (sa.size() != sb.size()) return false;
+        for (size_t j = 0; j < sa.size(); ++j) {
+            if (sa[j].day != sb[j].day
+                || sa[j].user_total_credit != sb[j].user_total_credit
+                || sa[j].user_expavg_credit != sb[j].user_expavg_credit
+                || sa[j].host_total_credit != sb[j].host_total_credit
+                || sa[j].host_expavg_credit != sb[j].host_expavg_credit
+            ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+
+void CMainDocument::ProcessRpcReplies() {
+    RPC_BUFFERS& buffers = m_pRpcThread->GetBuffers();
+    int retval;
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_STATE, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get State Failed '%d'"), retval);
+            m_pNetworkConnection->SetStateDisconnected();
+        } else {
+            state.swap(buffers.state);
+            host = buffers.host;
+
+            // The task view shows names from the state.
+            RestampResults();
+        }
+
+        CBOINCBaseFrame* pFrame = wxGetApp().GetFrame();
+        if (pFrame) {
+            wxASSERT(wxDynamicCast(pFrame, CBOINCBaseFrame));
+            pFrame->UpdateStatusText(wxEmptyString);
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_CC_STATUS, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Client Status Failed '%d'"), retval);
+            m_pNetworkConnection->SetStateDisconnected();
+        } else {
+            if (status.task_suspend_reason != buffers.status.task_suspend_reason) {
+                RestampResults();
+            }
+            if (status.network_suspend_reason != buffers.status.network_suspend_reason) {
+                RestampTransfers();
+            }
+            status = buffers.status;
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_PROJECT_STATUS, retval)) {
+        UpdateStateProjects(retval, buffers.project_status.projects);
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_RESULTS, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Result Status Failed '%d'"), retval);
+            ForceCacheUpdate();
+        } else {
+            results.results.swap(buffers.results.results);
+            update_stamps(results.results, buffers.results.results,
+                m_resultStamps, m_ulLastStamp, same_xml<RESULT>
+            );
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_MESSAGES, retval)) {
+        if (m_bIgnoreMessageReply) {
+            m_bIgnoreMessageReply = false;
+        } else if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Messages Failed '%d'"), retval);
+            m_pNetworkConnection->SetStateDisconnected();
+        } else if (!buffers.messages.messages.empty()) {
+            std::vector<MESSAGE*>& msgs = buffers.messages.messages;
+            if (!m_iMessageSequenceNumber) {
+                // The first page comes newest first.
+                m_bOlderMessages = (msgs.size() >= (size_t)RPC_MESSAGE_PAGE);
+                std::sort(msgs.begin(), msgs.end(), message_before);
+            }
+
+            // The new messages now belong to #messages.
+            messages.messages.insert(messages.messages.end(), msgs.begin(), msgs.end());
+            msgs.clear();
+            m_iMessageSequenceNumber = messages.messages.back()->seqno;
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_OLDER_MESSAGES, retval)) {
+        std::vector<MESSAGE*>& msgs = buffers.older_messages.messages;
+        if (m_bIgnoreOlderMessageReply) {
+            m_bIgnoreOlderMessageReply = false;
+        } else if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Older Messages Failed '%d'"), retval);
+        } else {
+            // Core clients without paging send all messages; only keep
+            // those before the first known one.
+            std::sort(msgs.begin(), msgs.end(), message_before);
+            std::vector<MESSAGE*>::iterator end = msgs.begin();
+            while ((end != msgs.end()) && !messages.messages.empty()
+                && ((*end)->seqno < messages.messages.front()->seqno)
+            ) {
+                ++end;
+            }
+            size_t count = end - msgs.begin();
+            messages.messages.insert(messages.messages.begin(), msgs.begin(), end);
+            msgs.erase(msgs.begin(), end);
+            m_iPrependedMessages += count;
+            m_bOlderMessages = (count >= (size_t)RPC_MESSAGE_PAGE);
+        }
+        buffers.older_messages.clear();
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_FILE_TRANSFERS, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get File Transfers Failed '%d'"), retval);
+            ForceCacheUpdate();
+        } else {
+            ft.file_transfers.swap(buffers.ft.file_transfers);
+            update_stamps(ft.file_transfers, buffers.ft.file_transfers,
+                m_transferStamps, m_ulLastStamp, same_xml<FILE_TRANSFER>
+            );
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_DISK_USAGE, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Disk Usage Failed '%d'"), retval);
+            ForceCacheUpdate();
+        } else {
+            disk_usage.projects.swap(buffers.disk_usage.projects);
+            disk_usage.d_total = buffers.disk_usage.d_total;
+            disk_usage.d_free = buffers.disk_usage.d_free;
+            disk_usage.d_boinc = buffers.disk_usage.d_boinc;
+            disk_usage.d_allowed = buffers.disk_usage.d_allowed;
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_STATISTICS, retval)) {
+        if (retval) {
+            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::ProcessRpcReplies - Get Statistics Failed '%d'"), retval);
+            ForceCacheUpdate();
+        } else {
+            statistics_status.projects.swap(buffers.statistics.projects);
+            if (!same_statistics(statistics_status.projects, buffers.statistics.projects)) {
+                m_ulStatisticsStamp++;
+            }
+        }
+    }
+
+    if (m_pRpcThread->TakeDone(RPC_REFRESH_SIMPLE_GUI, retval)) {
+        UpdateStateProjects(retval, buffers.simple_projects.projects);
+        if (!retval) {
+            results.results.swap(buffers.simple_results.results);
+            update_stamps(results.results, buffers.simple_results.results,
+                m_resultStamps, m_ulLastStamp, same_xml<RESULT>
+            );
+        }
+    }
+
+    m_pRpcThread->DispatchCommands();
+}
+
+
 int CMainDocument::OnRefreshState() {
     if (IsConnected()) {
         CachedStateUpdate();
@@ -430,24 +921,13 @@ int CMainDocument::CachedStateUpdate() {
 
     wxTimeSpan ts(wxDateTime::Now() - m_dtCachedStateTimestamp);
     if (IsConnected() && (ts.GetSeconds() > 3600)) {
-        wxASSERT(wxDynamicCast(pFrame, CBOINCBaseFrame));
-        pFrame->UpdateStatusText(_("Retrieving system state; please wait..."));
-
         m_dtCachedStateTimestamp = wxDateTime::Now();
-        retval = rpc.get_state(state);
-        if (retval) {
-            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedStateUpdate - Get State Failed '%d'"), retval);
-            m_pNetworkConnection->SetStateDisconnected();
-        }
-        pFrame->UpdateStatusText(_("Retrieving host information; please wait..."));
 
-        retval = rpc.get_host_info(host);
-        if (retval) {
-            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedStateUpdate - Get Host Information Failed '%d'"), retval);
-            m_pNetworkConnection->SetStateDisconnected();
+        // The status text is cleared by ProcessRpcReplies().
+        if (m_pRpcThread->Request(RPC_REFRESH_STATE)) {
+            wxASSERT(wxDynamicCast(pFrame, CBOINCBaseFrame));
+            pFrame->UpdateStatusText(_("Retrieving system state; please wait..."));
         }
-
-        pFrame->UpdateStatusText(wxEmptyString);
     }
 
     //wxLogTrace(wxT("Function Start/End"), wxT("CMainDocument::CachedStateUpdate - Function End"));
@@ -456,12 +936,16 @@ int CMainDocument::CachedStateUpdate() {
 
 
 int CMainDocument::ResetState() {
+    m_pRpcThread->Disconnect();
     rpc.close();
     state.clear();
     host.clear_host_info();
     results.clear();
+    m_resultStamps.clear();
     ft.clear();
+    m_transferStamps.clear();
     statistics_status.clear();
+    m_ulStatisticsStamp++;
     disk_usage.clear();
     proxy_info.clear();
 
@@ -553,16 +1037,9 @@ int CMainDocument::GetCoreClientStatus(CC_STATUS& ccs, bool bForce) {
         wxTimeSpan ts(wxDateTime::Now() - m_dtCachedCCStatusTimestamp);
         if ((ts.GetSeconds() > 0) || bForce) {
             m_dtCachedCCStatusTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_cc_status(ccs);
-            if (0 == iRetVal) {
-                status = ccs;
-            } else {
-                m_pNetworkConnection->SetStateDisconnected();
-            }
-        } else {
-            ccs = status;
+            m_pRpcThread->Request(RPC_REFRESH_CC_STATUS);
         }
+        ccs = status;
     } else {
         iRetVal = -1;
     }
@@ -572,40 +1049,20 @@ int CMainDocument::GetCoreClientStatus(CC_STATUS& ccs, bool bForce) {
 
 
 int CMainDocument::SetActivityRunMode(int iMode, int iTimeout) {
-    int       iRetVal = 0;
-    CC_STATUS ccs;
-
     if (IsConnected()) {
-        iRetVal = rpc.set_run_mode(iMode, iTimeout);
-        if (0 == iRetVal) {
-            if (RUN_MODE_RESTORE == iMode) {
-                GetCoreClientStatus(ccs, true);
-            } else {
-                status.task_mode = iMode;
-            }
-        }
+        m_pRpcThread->Submit(new CRunModeCommand(this, false, iMode, iTimeout));
     }
 
-    return iRetVal;
+    return 0;
 }
 
 
 int CMainDocument::SetNetworkRunMode(int iMode, int iTimeout) {
-    int       iRetVal = 0;
-    CC_STATUS ccs;
-
     if (IsConnected()) {
-        iRetVal = rpc.set_network_mode(iMode, iTimeout);
-        if (0 == iRetVal) {
-            if (RUN_MODE_RESTORE == iMode) {
-                GetCoreClientStatus(ccs, true);
-            } else {
-                status.network_mode = iMode;
-            }
-        }
+        m_pRpcThread->Submit(new CRunModeCommand(this, true, iMode, iTimeout));
     }
 
-    return iRetVal;
+    return 0;
 }
 
 
@@ -616,8 +1073,31 @@ int CMainDocument::ForceCacheUpdate() {
 }
 
 
+/// Collect the project, task and transfer operations until EndBatch(),
+/// to send them to the core client in one RPC. Used when the user does
+/// an operation on many selected items at once.
+void CMainDocument::BeginBatch() {
+    if (!m_pBatch) {
+        m_pBatch = new CBatchOpCommand(this);
+    }
+}
+
+
+/// Queue the operations collected since BeginBatch() for the RPC thread.
+void CMainDocument::EndBatch() {
+    CBatchOpCommand* pBatch = m_pBatch;
+    m_pBatch = NULL;
+    if (pBatch && !pBatch->IsEmpty()) {
+        m_pRpcThread->Submit(pBatch);
+    } else {
+        delete pBatch;
+    }
+}
+
+
 int CMainDocument::RunBenchmarks() {
-    return rpc.run_benchmarks();
+    m_pRpcThread->Submit(new CRunBenchmarksCommand());
+    return 0;
 }
 
 
@@ -682,23 +1162,12 @@ bool CMainDocument::IsUserAuthorized() {
 
 int CMainDocument::CachedProjectStatusUpdate() {
     int     iRetVal = 0;
-    int     i = 0;
 
     if (IsConnected()) {
         wxTimeSpan ts(wxDateTime::Now() - m_dtProjecStatusTimestamp);
         if (ts.GetSeconds() > 0) {
             m_dtProjecStatusTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_project_status(state);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedProjectStatusUpdate - Get Project Status Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
-
-            m_fProjectTotalResourceShare = 0.0;
-            for (i=0; i < (long)state.projects.size(); i++) {
-                m_fProjectTotalResourceShare += state.projects.at(i)->resource_share;
-            }
+            m_pRpcThread->Request(RPC_REFRESH_PROJECT_STATUS);
         }
     } else {
         iRetVal = -1;
@@ -708,6 +1177,56 @@ int CMainDocument::CachedProjectStatusUpdate() {
 }
 
 
+/// Copy the refreshed project status to the projects in the cached
+/// state. If a project was attached or detached, the state is fetched
+/// again.
+///
+/// \param[in] iRetVal The result of the refresh.
+/// \param[in] projects The projects that were received.
+void CMainDocument::UpdateStateProjects(int iRetVal, const std::vector<PROJECT*>& projects) {
+    size_t i;
+    bool bRestamp = false;
+
+    if (!iRetVal) {
+        for (i = 0; i < state.projects.size(); i++) {
+            state.projects[i]->flag_for_delete = true;
+        }
+        for (i = 0; i < projects.size(); i++) {
+            PROJECT* pStateProject = state.lookup_project(projects[i]->master_url);
+            if (pStateProject) {
+                // The task view shows these.
+                if (pStateProject->project_name != projects[i]->project_name
+                    || pStateProject->non_cpu_intensive != projects[i]->non_cpu_intensive
+                ) {
+                    bRestamp = true;
+                }
+                pStateProject->copy(*projects[i]);
+                pStateProject->flag_for_delete = false;
+            } else {
+                iRetVal = ERR_NOT_FOUND;
+            }
+        }
+        for (i = 0; !iRetVal && i < state.projects.size(); i++) {
+            if (state.projects[i]->flag_for_delete) {
+                iRetVal = ERR_FILE_MISSING;
+            }
+        }
+    }
+    if (iRetVal) {
+        wxLogTrace(wxT("Function Status"), wxT("CMainDocument::UpdateStateProjects - Get Project Status Failed '%d'"), iRetVal);
+        ForceCacheUpdate();
+    }
+    if (bRestamp) {
+        RestampResults();
+    }
+
+    m_fProjectTotalResourceShare = 0.0;
+    for (i = 0; i < state.projects.size(); i++) {
+        m_fProjectTotalResourceShare += state.projects[i]->resource_share;
+    }
+}
+
+
 PROJECT* CMainDocument::project(size_t i) {
     try {
         if (!state.projects.empty())
@@ -764,73 +1283,45 @@ size_t CMainDocument::GetProjectCount() {
 }
 
 int CMainDocument::ProjectDetach(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "detach");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "detach");
 }
 
 int CMainDocument::ProjectUpdate(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "update");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "update");
 }
 
 int CMainDocument::ProjectReset(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "reset");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "reset");
 }
 
 int CMainDocument::ProjectSuspend(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "suspend");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "suspend");
 }
 
 int CMainDocument::ProjectResume(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "resume");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "resume");
 }
 
 int CMainDocument::ProjectNoMoreWork(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
-
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "nomorework");
-
-    return iRetVal;
+    return ProjectOp(iIndex, "nomorework");
 }
 
 int CMainDocument::ProjectAllowMoreWork(size_t iIndex) {
-    int iRetVal = -1;
-    PROJECT* pProject = project(iIndex);
+    return ProjectOp(iIndex, "allowmorework");
+}
 
-    if (pProject)
-        iRetVal = rpc.project_op((*pProject), "allowmorework");
+/// Queue a project operation for the RPC thread.
+/// \return Zero if it was queued, -1 if there is no such project.
+int CMainDocument::ProjectOp(size_t iIndex, const char* op) {
+    PROJECT* pProject = project(iIndex);
 
-    return iRetVal;
+    if (!pProject) return -1;
+    if (m_pBatch) {
+        m_pBatch->AddProjectOp(*pProject, op);
+    } else {
+        m_pRpcThread->Submit(new CProjectOpCommand(this, *pProject, op));
+    }
+    return 0;
 }
 
 int CMainDocument::CachedResultsStatusUpdate() {
@@ -840,12 +1331,7 @@ int CMainDocument::CachedResultsStatusUpdate() {
         wxTimeSpan ts(wxDateTime::Now() - m_dtResultsTimestamp);
         if (ts.GetSeconds() > 0) {
             m_dtResultsTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_results(results);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedResultsStatusUpdate - Get Result Status Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
+            m_pRpcThread->Request(RPC_REFRESH_RESULTS);
         }
     } else {
         iRetVal = -1;
@@ -904,31 +1390,27 @@ size_t CMainDocument::GetWorkCount() {
 }
 
 
-int CMainDocument::WorkSuspend(const std::string& strProjectURL, const std::string& strName) {
-    int iRetVal = 0;
+unsigned long CMainDocument::GetResultStamp(size_t i) const {
+    return (i < m_resultStamps.size()) ? m_resultStamps[i] : 0;
+}
 
-    RESULT* pStateResult = state.lookup_result(strProjectURL, strName);
-    if (pStateResult) {
-        iRetVal = rpc.result_op((*pStateResult), "suspend");
-    } else {
-        ForceCacheUpdate();
-    }
 
-    return iRetVal;
+/// Give all results new stamps, after something that the task view
+/// shows for every result changed.
+void CMainDocument::RestampResults() {
+    for (size_t i = 0; i < m_resultStamps.size(); ++i) {
+        m_resultStamps[i] = ++m_ulLastStamp;
+    }
 }
 
 
-int CMainDocument::WorkResume(const std::string& strProjectURL, const std::string& strName) {
-    int iRetVal = 0;
+int CMainDocument::WorkSuspend(const std::string& strProjectURL, const std::string& strName) {
+    return WorkOp(strProjectURL, strName, "suspend");
+}
 
-    RESULT* pStateResult = state.lookup_result(strProjectURL, strName);
-    if (pStateResult) {
-        iRetVal = rpc.result_op((*pStateResult), "resume");
-    } else {
-        ForceCacheUpdate();
-    }
 
-    return iRetVal;
+int CMainDocument::WorkResume(const std::string& strProjectURL, const std::string& strName) {
+    return WorkOp(strProjectURL, strName, "resume");
 }
 
 
@@ -1179,47 +1661,37 @@ int CMainDocument::WorkShowGraphics(const RESULT* result)
 
 
 int CMainDocument::WorkAbort(const std::string& strProjectURL, const std::string& strName) {
-    int iRetVal = 0;
+    return WorkOp(strProjectURL, strName, "abort");
+}
 
+
+/// Queue a task operation for the RPC thread.
+int CMainDocument::WorkOp(const std::string& strProjectURL, const std::string& strName, const char* op) {
     RESULT* pStateResult = state.lookup_result(strProjectURL, strName);
-    if (pStateResult) {
-        iRetVal = rpc.result_op((*pStateResult), "abort");
+    if (pStateResult && m_pBatch) {
+        m_pBatch->AddResultOp(*pStateResult, op);
+    } else if (pStateResult) {
+        m_pRpcThread->Submit(new CResultOpCommand(this, *pStateResult, op));
     } else {
         ForceCacheUpdate();
     }
 
-    return iRetVal;
+    return 0;
 }
 
 
 int CMainDocument::CachedMessageUpdate() {
-    int retval;
-    static bool in_this_func = false;
     static bool was_connected = false;
 
-    if (in_this_func) return 0;
-    in_this_func = true;
-
     if (IsConnected()) {
         if (! was_connected) {
             ResetMessageState();
             was_connected = true;
         }
-        retval = rpc.get_messages(m_iMessageSequenceNumber, messages);
-        if (retval) {
-            wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedMessageUpdate - Get Messages Failed '%d'"), retval);
-            m_pNetworkConnection->SetStateDisconnected();
-            goto done;
-        }
-        if (!messages.messages.empty()) {
-            size_t last_ind = messages.messages.size()-1;
-            m_iMessageSequenceNumber = messages.messages[last_ind]->seqno;
-        }
+        m_pRpcThread->Request(RPC_REFRESH_MESSAGES, m_iMessageSequenceNumber);
     } else {
         was_connected = false;
     }
-done:
-    in_this_func = false;
     return 0;
 }
 
@@ -1248,12 +1720,39 @@ size_t CMainDocument::GetMessageCount() {
 
 
 int CMainDocument::ResetMessageState() {
+    int retval;
+
     messages.clear();
     m_iMessageSequenceNumber = 0;
+
+    m_bOlderMessages = false;
+    m_iPrependedMessages = 0;
+
+    // Messages that were asked for before belong to the old sequence.
+    if (m_pRpcThread) {
+        m_pRpcThread->TakeDone(RPC_REFRESH_MESSAGES, retval);
+        m_bIgnoreMessageReply = m_pRpcThread->IsPending(RPC_REFRESH_MESSAGES);
+        m_pRpcThread->TakeDone(RPC_REFRESH_OLDER_MESSAGES, retval);
+        m_bIgnoreOlderMessageReply = m_pRpcThread->IsPending(RPC_REFRESH_OLDER_MESSAGES);
+    }
     return 0;
 }
 
 
+void CMainDocument::LoadOlderMessages() {
+    if (IsConnected() && m_bOlderMessages && !messages.messages.empty()) {
+        m_pRpcThread->Request(RPC_REFRESH_OLDER_MESSAGES, messages.messages.front()->seqno);
+    }
+}
+
+
+size_t CMainDocument::TakePrependedMessageCount() {
+    size_t count = m_iPrependedMessages;
+    m_iPrependedMessages = 0;
+    return count;
+}
+
+
 int CMainDocument::CachedFileTransfersUpdate() {
     int     iRetVal = 0;
 
@@ -1261,12 +1760,7 @@ int CMainDocument::CachedFileTransfersUpdate() {
         wxTimeSpan ts(wxDateTime::Now() - m_dtFileTransfersTimestamp);
         if (ts.GetSeconds() > 0) {
             m_dtFileTransfersTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_file_transfers(ft);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedFileTransfersUpdate - Get File Transfers Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
+            m_pRpcThread->Request(RPC_REFRESH_FILE_TRANSFERS);
         }
     } else {
         iRetVal = -1;
@@ -1329,53 +1823,45 @@ size_t CMainDocument::GetTransferCount() {
 }
 
 
-int CMainDocument::TransferRetryNow(size_t iIndex) {
-    FILE_TRANSFER* pFT = NULL;
-    int iRetVal = 0;
-
-    pFT = file_transfer(iIndex);
+unsigned long CMainDocument::GetTransferStamp(size_t i) const {
+    return (i < m_transferStamps.size()) ? m_transferStamps[i] : 0;
+}
 
-    if (pFT)
-        iRetVal = rpc.file_transfer_op((*pFT), "retry");
 
-    return iRetVal;
+void CMainDocument::RestampTransfers() {
+    for (size_t i = 0; i < m_transferStamps.size(); ++i) {
+        m_transferStamps[i] = ++m_ulLastStamp;
+    }
 }
 
-int CMainDocument::TransferRetryNow(const wxString& fileName, const wxString& project_url) {
-    FILE_TRANSFER* pFT = NULL;
-    int iRetVal = 0;
-
-    pFT = file_transfer(fileName, project_url);
 
-    if (pFT)
-        iRetVal = rpc.file_transfer_op((*pFT), "retry");
+int CMainDocument::TransferRetryNow(size_t iIndex) {
+    return TransferOp(file_transfer(iIndex), "retry");
+}
 
-    return iRetVal;
+int CMainDocument::TransferRetryNow(const wxString& fileName, const wxString& project_url) {
+    return TransferOp(file_transfer(fileName, project_url), "retry");
 }
 
 
 int CMainDocument::TransferAbort(size_t iIndex) {
-    FILE_TRANSFER* pFT = NULL;
-    int iRetVal = 0;
-
-    pFT = file_transfer(iIndex);
-
-    if (pFT)
-        iRetVal = rpc.file_transfer_op((*pFT), "abort");
-
-    return iRetVal;
+    return TransferOp(file_transfer(iIndex), "abort");
 }
 
 int CMainDocument::TransferAbort(const wxString& fileName, const wxString& project_url) {
-    FILE_TRANSFER* pFT = NULL;
-    int iRetVal = 0;
+    return TransferOp(file_transfer(fileName, project_url), "abort");
+}
 
-    pFT = file_transfer(fileName, project_url);
 
-    if (pFT)
-        iRetVal = rpc.file_transfer_op((*pFT), "abort");
+/// Queue a file transfer operation for the RPC thread.
+int CMainDocument::TransferOp(const FILE_TRANSFER* pFT, const char* op) {
+    if (pFT && m_pBatch) {
+        m_pBatch->AddTransferOp(*pFT, op);
+    } else if (pFT) {
+        m_pRpcThread->Submit(new CTransferOpCommand(*pFT, op));
+    }
 
-    return iRetVal;
+    return 0;
 }
 
 
@@ -1390,12 +1876,7 @@ int CMainDocument::CachedDiskUsageUpdate() {
         //
         if ((ts.GetSeconds() > 60) || disk_usage.projects.empty()) {
             m_dtDiskUsageTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_disk_usage(disk_usage);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("Get Disk Usage Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
+            m_pRpcThread->Request(RPC_REFRESH_DISK_USAGE);
         }
     } else {
         iRetVal = -1;
@@ -1427,12 +1908,7 @@ int CMainDocument::CachedStatisticsStatusUpdate() {
         wxTimeSpan ts(wxDateTime::Now() - m_dtStatisticsStatusTimestamp);
         if ((ts.GetSeconds() > 0) || statistics_status.projects.empty()) {
             m_dtStatisticsStatusTimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_statistics(statistics_status);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedStatisticsStatusUpdate - Get Statistics Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
+            m_pRpcThread->Request(RPC_REFRESH_STATISTICS);
         }
     } else {
         iRetVal = -1;
@@ -1501,23 +1977,12 @@ int CMainDocument::SetProxyConfiguration() {
 
 int CMainDocument::CachedSimpleGUIUpdate() {
     int     iRetVal = 0;
-    int     i = 0;
 
     if (IsConnected()) {
         wxTimeSpan ts(wxDateTime::Now() - m_dtCachedSimpleGUITimestamp);
         if (ts.GetSeconds() > 0) {
             m_dtCachedSimpleGUITimestamp = wxDateTime::Now();
-
-            iRetVal = rpc.get_simple_gui_info(state, results);
-            if (iRetVal) {
-                wxLogTrace(wxT("Function Status"), wxT("CMainDocument::CachedSimpleGUIUpdate - Get Simple GUI Failed '%d'"), iRetVal);
-                ForceCacheUpdate();
-            }
-
-            m_fProjectTotalResourceShare = 0.0;
-            for (i=0; i < (long)state.projects.size(); i++) {
-                m_fProjectTotalResourceShare += state.projects.at(i)->resource_share;
-            }
+            m_pRpcThread->Request(RPC_REFRESH_SIMPLE_GUI);
         }
     } else {
         iRetVal = -1;
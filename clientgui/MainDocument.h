@@ -48,6 +48,8 @@ extern bool g_use_sandbox;
 
 class CMainDocument;
 class CBOINCClientManager;
+class CRpcThread;
+class CBatchOpCommand;
 
 class CNetworkConnection : public wxObject {
 public:
@@ -111,6 +113,10 @@ private:
     wxDateTime                  m_dtCachedCCStatusTimestamp;
     bool                        m_bClientStartCheckCompleted;
 
+    /// Take over the data refreshed by the RPC thread and finish the
+    /// commands it has done.
+    void                        ProcessRpcReplies();
+
 
 public:
     int                         OnInit();
@@ -151,10 +157,15 @@ public:
     int                         ForceCacheUpdate();
     int                         RunBenchmarks();
 
+    void                        BeginBatch();
+    void                        EndBatch();
+
     bool                        IsUserAuthorized();
 
     CNetworkConnection*         m_pNetworkConnection;
     CBOINCClientManager*        m_pClientManager;
+    CRpcThread*                 m_pRpcThread;
+    CBatchOpCommand*            m_pBatch; ///< Operations collected since BeginBatch().
     RPC_CLIENT                  rpc;
     CC_STATE                    state;
     CC_STATUS                   status;
@@ -167,6 +178,8 @@ public:
     //
 private:
     int                         CachedProjectStatusUpdate();
+    int                         ProjectOp(size_t iIndex, const char* op);
+    void                        UpdateStateProjects(int iRetVal, const std::vector<PROJECT*>& projects);
     wxDateTime                  m_dtProjecStatusTimestamp;
 
 public:
@@ -209,6 +222,16 @@ private:
 #else
     void                        KillGraphicsApp(int tpid);
 #endif
+    int                         WorkOp(
+                                    const std::string& strProjectURL,
+                                    const std::string& strName,
+                                    const char* op
+                                );
+    void                        RestampResults();
+    std::vector<unsigned long>  m_resultStamps;
+
+    /// The last change stamp given to a result or transfer.
+    unsigned long               m_ulLastStamp;
 
 public:
     RESULTS                     results;
@@ -217,6 +240,11 @@ public:
 
     size_t                      GetWorkCount();
 
+    /// Return the change stamp of result \a i. The stamp changes when
+    /// anything the views show about the result changes; 0 means the
+    /// result isn't known.
+    unsigned long               GetResultStamp(size_t i) const;
+
     int                         WorkSuspend(
                                     const std::string& strProjectURL,
                                     const std::string& strName
@@ -237,6 +265,10 @@ public:
     // Messages Tab
     //
 private:
+    bool                        m_bIgnoreMessageReply;
+    bool                        m_bIgnoreOlderMessageReply;
+    bool                        m_bOlderMessages;       ///< The core client may have older messages.
+    size_t                      m_iPrependedMessages;   ///< Older messages added since the last TakePrependedMessageCount().
 
 
 public:
@@ -248,6 +280,18 @@ public:
 
     int                         ResetMessageState();
 
+    /// Check if the core client may have messages older than those in
+    /// #messages. Only the newest page is loaded when connecting.
+    bool                        HasOlderMessages() const { return m_bOlderMessages; }
+
+    /// Ask the core client for the page of messages before the first one
+    /// in #messages. They are added at the front when they arrive.
+    void                        LoadOlderMessages();
+
+    /// Return how many older messages were added at the front of
+    /// #messages since the last call, so views can fix their indexes.
+    size_t                      TakePrependedMessageCount();
+
     int                         m_iMessageSequenceNumber;
 
 
@@ -256,7 +300,10 @@ public:
     //
 private:
     int                         CachedFileTransfersUpdate();
+    int                         TransferOp(const FILE_TRANSFER* pFT, const char* op);
     wxDateTime                  m_dtFileTransfersTimestamp;
+    void                        RestampTransfers();
+    std::vector<unsigned long>  m_transferStamps;
 
 public:
     FILE_TRANSFERS              ft;
@@ -265,6 +312,9 @@ public:
 
     size_t                      GetTransferCount();
 
+    /// Return the change stamp of transfer \a i, like GetResultStamp().
+    unsigned long               GetTransferStamp(size_t i) const;
+
     int                         TransferRetryNow(size_t iIndex);
     int                         TransferRetryNow(const wxString& fileName, const wxString& project_url);
     int                         TransferAbort(size_t iIndex);
@@ -288,12 +338,16 @@ public:
 private:
     int                         CachedStatisticsStatusUpdate();
     wxDateTime                  m_dtStatisticsStatusTimestamp;
+    unsigned long               m_ulStatisticsStamp;
 
 public:
     PROJECTS                    statistics_status;
     PROJECT*                    statistic(unsigned int);
 
     size_t                      GetStatisticsCount();
+
+    /// Return a stamp that changes whenever #statistics_status changes.
+    unsigned long               GetStatisticsStamp() const { return m_ulStatisticsStamp; }
     
 
     //
@@ -382,7 +382,7 @@ void CProjectPropertiesPage::OnStateChange(CProjectPropertiesPageEvent& WXUNUSED
             {
                 dtCurrentExecutionTime = wxDateTime::Now();
                 tsExecutionTime = dtCurrentExecutionTime - dtStartExecutionTime;
-                iReturnValue = pDoc->GetCoreClientStatus(status);
+                iReturnValue = pDoc->rpc.get_cc_status(status);
                 IncrementProgress(m_pProgressIndicator);
 
                 ::wxMilliSleep(500);
@@ -0,0 +1,131 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Bookkeeping of the RPC thread that doesn't depend on wxWidgets.
+
+#include "RpcQueue.h"
+
+CRpcRefreshQueue::CRpcRefreshQueue() {
+    for (int i = 0; i < RPC_REFRESH_COUNT; ++i) {
+        m_refresh[i] = IDLE;
+        m_retval[i] = 0;
+        m_seqno[i] = 0;
+    }
+}
+
+bool CRpcRefreshQueue::Request(RPC_REFRESH what, int seqno) {
+    switch (m_refresh[what]) {
+    case IDLE:
+        m_refresh[what] = QUEUED;
+        break;
+    case STALE:
+        // The reply for the old connection is thrown away, so this
+        // request must not be coalesced with it.
+        m_refresh[what] = STALE_QUEUED;
+        break;
+    default:
+        return false;
+    }
+    m_seqno[what] = seqno;
+    return true;
+}
+
+bool CRpcRefreshQueue::IsPending(RPC_REFRESH what) const {
+    switch (m_refresh[what]) {
+    case QUEUED:
+    case RUNNING:
+    case STALE_QUEUED:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+bool CRpcRefreshQueue::TakeDone(RPC_REFRESH what, int& retval) {
+    if (m_refresh[what] != DONE) return false;
+    m_refresh[what] = IDLE;
+    retval = m_retval[what];
+    return true;
+}
+
+void CRpcRefreshQueue::Drop() {
+    for (int i = 0; i < RPC_REFRESH_COUNT; ++i) {
+        switch (m_refresh[i]) {
+        case QUEUED:
+        case DONE:
+            m_refresh[i] = IDLE;
+            break;
+        case RUNNING:
+        case STALE_QUEUED:
+            m_refresh[i] = STALE;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool CRpcRefreshQueue::Start(RPC_REFRESH& what, int& seqno) {
+    for (int i = 0; i < RPC_REFRESH_COUNT; ++i) {
+        if (m_refresh[i] == QUEUED) {
+            m_refresh[i] = RUNNING;
+            what = (RPC_REFRESH)i;
+            seqno = m_seqno[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void CRpcRefreshQueue::Finish(RPC_REFRESH what, int retval) {
+    switch (m_refresh[what]) {
+    case RUNNING:
+        m_refresh[what] = DONE;
+        m_retval[what] = retval;
+        break;
+    case STALE_QUEUED:
+        m_refresh[what] = QUEUED;
+        break;
+    default:
+        m_refresh[what] = IDLE;
+        break;
+    }
+}
+
+CRpcRetry::CRpcRetry(double min_delay, double max_delay)
+    : m_minDelay(min_delay), m_maxDelay(max_delay), m_delay(0), m_next(0)
+{
+}
+
+void CRpcRetry::Reset() {
+    m_delay = 0;
+    m_next = 0;
+}
+
+void CRpcRetry::Failed(double now) {
+    m_delay = m_delay ? 2 * m_delay : m_minDelay;
+    if (m_delay > m_maxDelay) {
+        m_delay = m_maxDelay;
+    }
+    m_next = now + m_delay;
+}
+
+double CRpcRetry::Remaining(double now) const {
+    return (now < m_next) ? (m_next - now) : 0;
+}
@@ -0,0 +1,118 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Bookkeeping of the RPC thread that doesn't depend on wxWidgets:
+/// the state of the double-buffered refreshes, and the delays between
+/// attempts to connect to the client. The RPC thread holds its lock
+/// while it uses these classes.
+
+#ifndef RPCQUEUE_H
+#define RPCQUEUE_H
+
+/// The kinds of data refreshed by the RPC thread.
+enum RPC_REFRESH {
+    RPC_REFRESH_STATE,          ///< get_state and get_host_info.
+    RPC_REFRESH_CC_STATUS,
+    RPC_REFRESH_PROJECT_STATUS,
+    RPC_REFRESH_RESULTS,
+    RPC_REFRESH_MESSAGES,       ///< New messages only.
+    RPC_REFRESH_OLDER_MESSAGES, ///< A page of messages older than the known ones.
+    RPC_REFRESH_FILE_TRANSFERS,
+    RPC_REFRESH_DISK_USAGE,
+    RPC_REFRESH_STATISTICS,
+    RPC_REFRESH_SIMPLE_GUI,     ///< Project status and results.
+    RPC_REFRESH_COUNT
+};
+
+/// The refreshes requested from the RPC thread.
+///
+/// Each kind of refresh goes from requested to running to done, and
+/// back to idle when the GUI thread takes the back buffer it filled.
+/// Only then the GUI thread may use that buffer, and only then a new
+/// request for the same kind is queued. When the connection changes,
+/// the queued refreshes are dropped and a running one becomes stale:
+/// its reply belongs to the old connection and is thrown away.
+class CRpcRefreshQueue {
+public:
+    CRpcRefreshQueue();
+
+    /// Ask for a refresh of \a what with the sequence number \a seqno.
+    /// \return False if the same refresh is already pending.
+    bool Request(RPC_REFRESH what, int seqno);
+
+    /// Return true if a refresh of \a what was requested and isn't done.
+    bool IsPending(RPC_REFRESH what) const;
+
+    /// If the refresh of \a what is done, return true and its result
+    /// in \a retval, and give its buffer back to the GUI thread.
+    bool TakeDone(RPC_REFRESH what, int& retval);
+
+    /// Forget the queued refreshes and those that weren't taken yet,
+    /// and make the running ones stale.
+    void Drop();
+
+    /// Take the next queued refresh to be run.
+    /// \return False if none is queued.
+    bool Start(RPC_REFRESH& what, int& seqno);
+
+    /// The refresh of \a what that was started is over.
+    void Finish(RPC_REFRESH what, int retval);
+
+private:
+    enum REFRESH_STATE {
+        IDLE,
+        QUEUED,
+        RUNNING,
+        STALE,          ///< Running for an old connection; ignored when done.
+        STALE_QUEUED,   ///< Like STALE, but queued again when done.
+        DONE
+    };
+
+    REFRESH_STATE m_refresh[RPC_REFRESH_COUNT];
+    int m_retval[RPC_REFRESH_COUNT];
+    int m_seqno[RPC_REFRESH_COUNT];
+};
+
+/// Delays between attempts to connect to the client, doubling after
+/// each failure up to a maximum.
+class CRpcRetry {
+public:
+    CRpcRetry(double min_delay, double max_delay);
+
+    /// Allow an attempt right away, e.g. after a connection was lost.
+    void Reset();
+
+    /// An attempt at \a now failed.
+    void Failed(double now);
+
+    /// Return true if the next attempt may be made at \a now.
+    bool Due(double now) const {
+        return now >= m_next;
+    }
+
+    /// Return the time until the next attempt, in seconds.
+    double Remaining(double now) const;
+
+private:
+    double m_minDelay;
+    double m_maxDelay;
+    double m_delay;     ///< Delay after the last failure, 0 if none.
+    double m_next;      ///< Time of the next attempt.
+};
+
+#endif // RPCQUEUE_H
@@ -0,0 +1,325 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// The thread that does the GUI RPCs of the Manager's views.
+
+#include "RpcThread.h"
+
+#include "stdwx.h"
+
+#ifdef _MSC_VER
+#include <locale.h>
+#endif
+
+#include "error_numbers.h"
+#include "util.h"
+
+/// Delay before the first new attempt to connect after one failed.
+#define RETRY_MIN_DELAY 1.0
+
+/// Longest delay between attempts to connect.
+#define RETRY_MAX_DELAY 60.0
+
+CRpcThread::CRpcThread()
+    : wxThread(wxTHREAD_JOINABLE), m_bStarted(false), m_cond(m_mutex),
+    m_bQuit(false), m_bConnectWanted(false), m_bConnected(false),
+    m_iGeneration(0), m_iConnection(0),
+    m_retry(RETRY_MIN_DELAY, RETRY_MAX_DELAY), m_iPort(GUI_RPC_PORT)
+{
+}
+
+CRpcThread::~CRpcThread() {
+    while (!m_commands.empty()) {
+        delete m_commands.front().cmd;
+        m_commands.pop_front();
+    }
+    while (!m_doneCommands.empty()) {
+        delete m_doneCommands.front().cmd;
+        m_doneCommands.pop_front();
+    }
+}
+
+int CRpcThread::Start() {
+    if (m_bStarted) return 0;
+    if (Create() != wxTHREAD_NO_ERROR) return ERR_THREAD;
+    if (Run() != wxTHREAD_NO_ERROR) return ERR_THREAD;
+    m_bStarted = true;
+    return 0;
+}
+
+/// An RPC that is being done is finished first; with a remote client
+/// this can take until the RPC times out.
+void CRpcThread::Stop() {
+    if (!m_bStarted) return;
+    {
+        wxMutexLocker lock(m_mutex);
+        m_bQuit = true;
+        DropQueued();
+        m_cond.Signal();
+    }
+    Wait();
+    m_bStarted = false;
+}
+
+void CRpcThread::Connect(const std::string& host, int port, const std::string& password) {
+    wxMutexLocker lock(m_mutex);
+    m_strHost = host;
+    m_iPort = port;
+    m_strPassword = password;
+    m_bConnectWanted = true;
+    m_iGeneration++;
+    m_retry.Reset();
+    DropQueued();
+    m_cond.Signal();
+}
+
+void CRpcThread::Disconnect() {
+    wxMutexLocker lock(m_mutex);
+    if (!m_bConnectWanted) return;
+    m_bConnectWanted = false;
+    m_iGeneration++;
+    DropQueued();
+    m_cond.Signal();
+}
+
+bool CRpcThread::Request(RPC_REFRESH what, int seqno) {
+    wxMutexLocker lock(m_mutex);
+    if (!m_refreshes.Request(what, seqno)) {
+        return false;
+    }
+    m_cond.Signal();
+    return true;
+}
+
+bool CRpcThread::IsPending(RPC_REFRESH what) {
+    wxMutexLocker lock(m_mutex);
+    return m_refreshes.IsPending(what);
+}
+
+void CRpcThread::Submit(CRpcCommand* cmd) {
+    wxMutexLocker lock(m_mutex);
+    COMMAND c;
+    c.cmd = cmd;
+    c.retval = 0;
+    c.generation = m_iGeneration;
+    m_commands.push_back(c);
+    m_cond.Signal();
+}
+
+bool CRpcThread::TakeDone(RPC_REFRESH what, int& retval) {
+    wxMutexLocker lock(m_mutex);
+    return m_refreshes.TakeDone(what, retval);
+}
+
+void CRpcThread::DispatchCommands() {
+    std::deque<COMMAND> done;
+    {
+        wxMutexLocker lock(m_mutex);
+        done.swap(m_doneCommands);
+    }
+
+    // Done() may submit new commands, so the lock isn't held here.
+    while (!done.empty()) {
+        COMMAND c = done.front();
+        done.pop_front();
+        c.cmd->Done(c.retval);
+        delete c.cmd;
+    }
+}
+
+/// Forget the queued work and the refreshes that weren't taken yet.
+/// Must be called with #m_mutex locked.
+void CRpcThread::DropQueued() {
+    m_refreshes.Drop();
+    while (!m_commands.empty()) {
+        delete m_commands.front().cmd;
+        m_commands.pop_front();
+    }
+    while (!m_doneCommands.empty()) {
+        delete m_doneCommands.front().cmd;
+        m_doneCommands.pop_front();
+    }
+}
+
+/// If an RPC failed because the connection is gone, e.g. because the
+/// client was restarted, close it so that the thread connects again.
+/// Must be called with #m_mutex locked.
+void CRpcThread::CheckConnection(int retval) {
+    if (!m_bConnected) return;
+    if (retval != ERR_READ && retval != ERR_WRITE && retval != ERR_CONNECT) return;
+    wxLogTrace(wxT("Function Status"), wxT("CRpcThread::CheckConnection - Connection Lost '%d'"), retval);
+    m_bConnected = false;
+    m_retry.Reset();
+}
+
+int CRpcThread::DoConnect(const std::string& host, int port, const std::string& password) {
+    int retval = m_rpc.init(host.empty() ? NULL : host.c_str(), port);
+    if (retval) {
+        wxLogTrace(wxT("Function Status"), wxT("CRpcThread::DoConnect - RPC Connection Failed '%d'"), retval);
+        return retval;
+    }
+    retval = m_rpc.authorize(password.c_str());
+    if (retval) {
+        wxLogTrace(wxT("Function Status"), wxT("CRpcThread::DoConnect - RPC Authorization Failed '%d'"), retval);
+        m_rpc.close();
+    }
+    return retval;
+}
+
+/// Fill in the back buffer of \a what.
+int CRpcThread::DoRefresh(RPC_REFRESH what, int seqno) {
+    int retval = 0;
+
+    switch (what) {
+    case RPC_REFRESH_STATE:
+        retval = m_rpc.get_state(m_buffers.state);
+        if (!retval) {
+            retval = m_rpc.get_host_info(m_buffers.host);
+        }
+        break;
+    case RPC_REFRESH_CC_STATUS:
+        retval = m_rpc.get_cc_status(m_buffers.status);
+        break;
+    case RPC_REFRESH_PROJECT_STATUS:
+        retval = m_rpc.get_project_status(m_buffers.project_status);
+        break;
+    case RPC_REFRESH_RESULTS:
+        retval = m_rpc.get_results(m_buffers.results);
+        break;
+    case RPC_REFRESH_MESSAGES:
+        m_buffers.messages.clear();
+        if (seqno) {
+            retval = m_rpc.get_messages(seqno, m_buffers.messages);
+        } else {
+            // Older messages are only loaded when the user scrolls back.
+            MESSAGE_FILTER filter;
+            filter.max_count = RPC_MESSAGE_PAGE;
+            filter.newest_first = true;
+            retval = m_rpc.get_messages(0, m_buffers.messages, filter);
+        }
+        break;
+    case RPC_REFRESH_OLDER_MESSAGES:
+        {
+            MESSAGE_FILTER filter;
+            filter.before_seqno = seqno;
+            filter.max_count = RPC_MESSAGE_PAGE;
+            filter.newest_first = true;
+            m_buffers.older_messages.clear();
+            retval = m_rpc.get_messages(0, m_buffers.older_messages, filter);
+        }
+        break;
+    case RPC_REFRESH_FILE_TRANSFERS:
+        retval = m_rpc.get_file_transfers(m_buffers.ft);
+        break;
+    case RPC_REFRESH_DISK_USAGE:
+        retval = m_rpc.get_disk_usage(m_buffers.disk_usage);
+        break;
+    case RPC_REFRESH_STATISTICS:
+        retval = m_rpc.get_statistics(m_buffers.statistics);
+        break;
+    case RPC_REFRESH_SIMPLE_GUI:
+        {
+            SIMPLE_GUI_INFO sgi;
+            retval = m_rpc.get_simple_gui_info(sgi);
+            m_buffers.simple_projects.clear();
+            m_buffers.simple_results.clear();
+            m_buffers.simple_projects.projects.swap(sgi.projects);
+            m_buffers.simple_results.results.swap(sgi.results);
+        }
+        break;
+    default:
+        retval = ERR_NOT_IMPLEMENTED;
+        break;
+    }
+    return retval;
+}
+
+wxThread::ExitCode CRpcThread::Entry() {
+#ifdef _MSC_VER
+    // SET_LOCALE then only changes the locale of this thread.
+    _configthreadlocale(_ENABLE_PER_THREAD_LOCALE);
+#endif
+
+    wxMutexLocker lock(m_mutex);
+    while (!m_bQuit) {
+        bool retry = m_bConnectWanted && !m_bConnected && m_retry.Due(dtime());
+        if (m_iConnection != m_iGeneration || retry) {
+            int generation = m_iGeneration;
+            bool wanted = m_bConnectWanted;
+            std::string host = m_strHost;
+            int port = m_iPort;
+            std::string password = m_strPassword;
+            m_mutex.Unlock();
+
+            m_rpc.close();
+            int retval = wanted ? DoConnect(host, port, password) : ERR_CONNECT;
+
+            m_mutex.Lock();
+            m_iConnection = generation;
+            m_bConnected = !retval;
+            if (wanted && retval) {
+                m_retry.Failed(dtime());
+            }
+            continue;
+        }
+
+        // Commands go first: a refresh that was asked for after a
+        // command should show its effect.
+        if (!m_commands.empty()) {
+            COMMAND c = m_commands.front();
+            m_commands.pop_front();
+            m_mutex.Unlock();
+
+            c.retval = m_bConnected ? c.cmd->Run(m_rpc) : ERR_CONNECT;
+
+            m_mutex.Lock();
+            if (m_iConnection == m_iGeneration) {
+                CheckConnection(c.retval);
+            }
+            if (c.generation == m_iGeneration) {
+                m_doneCommands.push_back(c);
+            } else {
+                delete c.cmd;
+            }
+            continue;
+        }
+
+        RPC_REFRESH what;
+        int seqno;
+        if (!m_refreshes.Start(what, seqno)) {
+            if (m_bConnectWanted && !m_bConnected) {
+                // Wake up for the next attempt to connect.
+                m_cond.WaitTimeout((unsigned long)(m_retry.Remaining(dtime()) * 1000) + 1);
+            } else {
+                m_cond.Wait();
+            }
+            continue;
+        }
+        m_mutex.Unlock();
+
+        int retval = m_bConnected ? DoRefresh(what, seqno) : ERR_CONNECT;
+
+        m_mutex.Lock();
+        if (m_iConnection == m_iGeneration) {
+            CheckConnection(retval);
+        }
+        m_refreshes.Finish(what, retval);
+    }
+    m_rpc.close();
+    return 0;
+}
@@ -0,0 +1,162 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// The thread that does the GUI RPCs of the Manager's views.
+///
+/// With a slow or remote client, or a large client state, an RPC can
+/// take seconds. CRpcThread has its own connection to the client and
+/// does the periodic refreshes of the cached data and the operations
+/// requested by the user there, so that the GUI thread never waits for
+/// the client.
+///
+/// Refreshes are double buffered: the thread fills a back buffer of
+/// each kind of data, and CMainDocument swaps it with the data shown by
+/// the views, in the GUI thread, once the refresh is done. A refresh
+/// that is requested while the same refresh is waiting or running is
+/// dropped, so repeated requests from the views cost one RPC.
+///
+/// If the thread can't connect, or loses the connection (e.g. because
+/// the client was restarted), it tries again, waiting longer after each
+/// failure. Meanwhile, work fails with ERR_CONNECT.
+
+#ifndef RPCTHREAD_H
+#define RPCTHREAD_H
+
+#include <deque>
+#include <string>
+
+#include <wx/thread.h>
+
+#include "gui_rpc_client.h"
+#include "hostinfo.h"
+
+#include "RpcQueue.h"
+
+/// Number of messages asked for at a time when the messages are paged.
+const int RPC_MESSAGE_PAGE = 250;
+
+/// Back buffers filled in by the RPC thread.
+/// Only touched by the GUI thread while the refresh isn't pending.
+struct RPC_BUFFERS {
+    CC_STATE state;
+    HOST_INFO host;
+    CC_STATUS status;
+    PROJECTS project_status;
+    RESULTS results;
+    MESSAGES messages;
+    MESSAGES older_messages;
+    FILE_TRANSFERS ft;
+    DISK_USAGE disk_usage;
+    PROJECTS statistics;
+    PROJECTS simple_projects;   ///< Project status for the simple GUI.
+    RESULTS simple_results;     ///< Results for the simple GUI.
+};
+
+/// An operation that the RPC thread does for the user.
+class CRpcCommand {
+public:
+    virtual ~CRpcCommand() {}
+
+    /// Do the operation. Called in the RPC thread.
+    virtual int Run(RPC_CLIENT& rpc) = 0;
+
+    /// Called in the GUI thread after Run() with its return value.
+    virtual void Done(int WXUNUSED(retval)) {}
+};
+
+class CRpcThread : public wxThread {
+public:
+    CRpcThread();
+    ~CRpcThread();
+
+    /// Start the thread.
+    int Start();
+
+    /// Drop queued work and wait until the thread ends.
+    void Stop();
+
+    /// Connect to the client on \a host (empty for this computer).
+    /// Queued work is dropped, and work that is running is ignored
+    /// when it's done.
+    void Connect(const std::string& host, int port, const std::string& password);
+
+    /// Close the connection and drop queued work.
+    void Disconnect();
+
+    /// Ask for a refresh of \a what. For new messages, \a seqno is the
+    /// sequence number of the last message already known, or zero to
+    /// get only the newest page. For older messages, it's the sequence
+    /// number of the first message already known.
+    /// \return False if the same refresh is already pending.
+    bool Request(RPC_REFRESH what, int seqno = 0);
+
+    /// Return true if a refresh of \a what was requested and isn't done.
+    bool IsPending(RPC_REFRESH what);
+
+    /// Queue a command. The thread owns \a cmd from now on.
+    void Submit(CRpcCommand* cmd);
+
+    /// If the refresh of \a what is done, return true and its result
+    /// in \a retval. The data is then in GetBuffers() until the next
+    /// request for \a what.
+    bool TakeDone(RPC_REFRESH what, int& retval);
+
+    /// Call Done() for the commands that are done, and delete them.
+    void DispatchCommands();
+
+    RPC_BUFFERS& GetBuffers() { return m_buffers; }
+
+protected:
+    virtual ExitCode Entry();
+
+private:
+    struct COMMAND {
+        CRpcCommand* cmd;
+        int retval;
+        int generation;
+    };
+
+    RPC_CLIENT m_rpc;           ///< Only used by the thread.
+    RPC_BUFFERS m_buffers;
+    bool m_bStarted;
+
+    /// @name Protected by #m_mutex
+    /// @{
+    wxMutex m_mutex;
+    wxCondition m_cond;
+    bool m_bQuit;
+    bool m_bConnectWanted;
+    bool m_bConnected;          ///< The thread's connection is up.
+    int m_iGeneration;          ///< Counts Connect() and Disconnect() calls.
+    int m_iConnection;          ///< Generation of the thread's connection.
+    CRpcRetry m_retry;          ///< When to connect again after a failure.
+    std::string m_strHost;
+    int m_iPort;
+    std::string m_strPassword;
+    CRpcRefreshQueue m_refreshes;
+    std::deque<COMMAND> m_commands;
+    std::deque<COMMAND> m_doneCommands;
+    /// @}
+
+    void DropQueued();
+    void CheckConnection(int retval);
+    int DoConnect(const std::string& host, int port, const std::string& password);
+    int DoRefresh(RPC_REFRESH what, int seqno);
+};
+
+#endif // RPCTHREAD_H
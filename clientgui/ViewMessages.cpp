@@ -18,6 +18,8 @@
 
 #include "ViewMessages.h"
 
+#include <algorithm>
+
 #include "stdwx.h"
 #include "AdvancedFrame.h"
 #include "BOINCBaseFrame.h"
@@ -294,6 +296,17 @@ void CViewMessages::OnListRender (wxTimerEvent& event) {
 
         wxASSERT(m_pListPane);
 
+        // Older messages are loaded when the user scrolls to the top.
+        if (pDoc->HasOlderMessages() && (m_iPreviousDocCount > 0) && (m_pListPane->GetTopItem() == 0)) {
+            pDoc->LoadOlderMessages();
+        }
+        size_t iPrepended = pDoc->TakePrependedMessageCount();
+        if (iPrepended) {
+            // The indexes of all messages changed.
+            m_filteredIndexes.clear();
+            m_maxFilteredIndex = 0;
+        }
+
         isConnected = pDoc->IsConnected();
         wxInt32 iDocCount = GetDocCount();
         if (0 >= iDocCount) {
@@ -323,7 +336,17 @@ void CViewMessages::OnListRender (wxTimerEvent& event) {
                 m_pListPane->SetItemCount(iDocCount);
         }
 
-        if ((iDocCount > 1) && (_EnsureLastItemVisible()) && (m_iPreviousDocCount != iDocCount)) {
+        if (iPrepended) {
+            // Keep the message that was at the top in view.
+            long lRow = (long)iPrepended;
+            if (m_enableMsgFilter) {
+                lRow = std::lower_bound(m_filteredIndexes.begin(), m_filteredIndexes.end(), iPrepended)
+                    - m_filteredIndexes.begin();
+            }
+            if (lRow < iDocCount) {
+                m_pListPane->EnsureVisible(lRow);
+            }
+        } else if ((iDocCount > 1) && (_EnsureLastItemVisible()) && (m_iPreviousDocCount != iDocCount)) {
             m_pListPane->EnsureVisible(iDocCount - 1);
         }
 
@@ -238,6 +238,7 @@ void CViewProjects::OnProjectUpdate( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
 
     pFrame->UpdateStatusText(_("Updating project..."));
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -246,6 +247,7 @@ void CViewProjects::OnProjectUpdate( wxCommandEvent& WXUNUSED(event) ) {
         
         pDoc->ProjectUpdate(m_iSortedIndexes[row]);
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -269,6 +271,7 @@ void CViewProjects::OnProjectSuspend( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -283,6 +286,7 @@ void CViewProjects::OnProjectSuspend( wxCommandEvent& WXUNUSED(event) ) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -305,6 +309,7 @@ void CViewProjects::OnProjectResume( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -319,6 +324,7 @@ void CViewProjects::OnProjectResume( wxCommandEvent& WXUNUSED(event) ) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -341,6 +347,7 @@ void CViewProjects::OnProjectNoNewWork( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -355,6 +362,7 @@ void CViewProjects::OnProjectNoNewWork( wxCommandEvent& WXUNUSED(event) ) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -377,6 +385,7 @@ void CViewProjects::OnProjectAllowNewWork( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -391,6 +400,7 @@ void CViewProjects::OnProjectAllowNewWork( wxCommandEvent& WXUNUSED(event) ) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -420,6 +430,7 @@ void CViewProjects::OnProjectReset( wxCommandEvent& WXUNUSED(event) ) {
 
     pFrame->UpdateStatusText(_("Resetting project..."));
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -445,6 +456,7 @@ void CViewProjects::OnProjectReset( wxCommandEvent& WXUNUSED(event) ) {
         }
     }
     
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
@@ -472,6 +484,7 @@ void CViewProjects::OnProjectDetach( wxCommandEvent& WXUNUSED(event) ) {
     pFrame->UpdateStatusText(_("Detaching from project..."));
 
     std::vector<size_t> selectedProjects;
+    pDoc->BeginBatch();
     int row = -1;
     while (1) {
         // Step through all selected items
@@ -495,6 +508,7 @@ void CViewProjects::OnProjectDetach( wxCommandEvent& WXUNUSED(event) ) {
         }
     }
 
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     m_bForceUpdateSelection = true;
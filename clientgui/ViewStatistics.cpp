@@ -164,8 +164,11 @@ CPaintStatistics::CPaintStatistics(wxWindow* parent, wxWindowID id, const wxPoin
     m_pen_GraphColour09 = wxColour(160, 0, 0);
 
     m_dc_bmp.Create(1, 1);
+    m_graph_bmp.Create(1, 1);
     m_full_repaint = true;
+    m_overlay_repaint = false;
     m_bmp_OK = false;
+    m_statistics_stamp = 0;
 }
 static void getTypePoint(int &typePoint, int number) {typePoint = number / 10;}
 
@@ -275,6 +278,50 @@ static void MinMaxDayCredit(std::vector<PROJECT*>::const_iterator &i, double &mi
         }
     }
 }
+static double StatValue(const DAILY_STATS& stats, const int m_SelectedStatistic) {
+    switch (m_SelectedStatistic){
+    case 0: return stats.user_total_credit;
+    case 1: return stats.user_expavg_credit;
+    case 2: return stats.host_total_credit;
+    case 3: return stats.host_expavg_credit;
+    default: return stats.user_total_credit;
+    }
+}
+/// Return the pixel column of \a x. All points left of the graph are in
+/// one column, and all points right of it in another.
+static long PixelColumn(const double x, const double x_start, const double x_end) {
+    if (x < x_start) return -1;
+    if (x > x_end) return -2;
+    return long(floor(x));
+}
+//----Decimate a series----
+/// Keep the first, lowest, highest and last point of each pixel column,
+/// in their order. The lines between them stay in their column, so the
+/// graph looks the same as with all points.
+static void DecimateStats(const std::vector<DAILY_STATS>& stats, const int m_SelectedStatistic, const double ax, const double bx, const double x_start, const double x_end, std::vector<wxRealPoint>& points) {
+    points.clear();
+    const size_t n = stats.size();
+    size_t j = 0;
+    while (j < n) {
+        const long column = PixelColumn(ax * stats[j].day + bx, x_start, x_end);
+        size_t lo = j;
+        size_t hi = j;
+        size_t k;
+        for (k = j + 1; k < n; ++k) {
+            if (PixelColumn(ax * stats[k].day + bx, x_start, x_end) != column) break;
+            const double val = StatValue(stats[k], m_SelectedStatistic);
+            if (val < StatValue(stats[lo], m_SelectedStatistic)) lo = k;
+            if (val > StatValue(stats[hi], m_SelectedStatistic)) hi = k;
+        }
+        const size_t keep[4] = {j, std::min(lo, hi), std::max(lo, hi), k - 1};
+        for (int m = 0; m < 4; ++m) {
+            if ((m > 0) && (keep[m] == keep[m - 1])) continue;
+            const DAILY_STATS& point = stats[keep[m]];
+            points.push_back(wxRealPoint(point.day, StatValue(point, m_SelectedStatistic)));
+        }
+        j = k;
+    }
+}
 static void CheckMinMaxD(double &min_val, double &max_val) {
     if (min_val > max_val) min_val = max_val;
     if (max_val == min_val){
@@ -762,6 +809,25 @@ void CPaintStatistics::DrawAxis(wxDC &dc, const double max_val_y, const double m
     }
     dc.DestroyClippingRegion();
 }
+//----Get decimated series----
+/// The series is kept until the statistics, the scale of the x axis or
+/// the graph area change.
+const std::vector<wxRealPoint>& CPaintStatistics::GetDecimatedSeries(const PROJECT* project, const int statistic) {
+    DECIMATED_SERIES& series = m_decimated[project->master_url];
+    if ((series.points.empty() && !project->statistics.empty()) ||
+        (series.stamp != m_statistics_stamp) || (series.statistic != statistic) ||
+        (series.ax != m_Ax_ValToCoord) || (series.bx != m_Bx_ValToCoord) ||
+        (series.x_start != m_Graph_X_start) || (series.x_end != m_Graph_X_end)){
+        series.stamp = m_statistics_stamp;
+        series.statistic = statistic;
+        series.ax = m_Ax_ValToCoord;
+        series.bx = m_Bx_ValToCoord;
+        series.x_start = m_Graph_X_start;
+        series.x_end = m_Graph_X_end;
+        DecimateStats(project->statistics, statistic, m_Ax_ValToCoord, m_Bx_ValToCoord, m_Graph_X_start, m_Graph_X_end, series.points);
+    }
+    return series.points;
+}
 //----Draw graph----
 void CPaintStatistics::DrawGraph(wxDC &dc, std::vector<PROJECT*>::const_iterator &i, const wxColour graphColour, const int typePoint, const int m_SelectedStatistic) {
     wxCoord x0 = wxCoord(m_Graph_X_start);
@@ -801,7 +867,8 @@ void CPaintStatistics::DrawGraph(wxDC &dc, std::vector<PROJECT*>::const_iterator
     double d_end_point_y = 0;
     bool end_point = false;
 //
-    for (std::vector<DAILY_STATS>::const_iterator j = (*i)->statistics.begin(); j != (*i)->statistics.end(); ++j) {
+    const std::vector<wxRealPoint>& points = GetDecimatedSeries(*i, m_SelectedStatistic);
+    for (std::vector<wxRealPoint>::const_iterator j = points.begin(); j != points.end(); ++j) {
         double d_x1 = 0;
         double d_y1 = 0;
         double d_x2 = 0;
@@ -814,14 +881,8 @@ void CPaintStatistics::DrawGraph(wxDC &dc, std::vector<PROJECT*>::const_iterator
         b_point1 = false;
         b_point2 = false;
 
-        d_xpos = (m_Ax_ValToCoord * j->day + m_Bx_ValToCoord);//  
-        switch (m_SelectedStatistic){  //  
-        case 0: d_ypos = (m_Ay_ValToCoord * j->user_total_credit + m_By_ValToCoord);    break;
-        case 1: d_ypos = (m_Ay_ValToCoord * j->user_expavg_credit + m_By_ValToCoord);   break;
-        case 2: d_ypos = (m_Ay_ValToCoord * j->host_total_credit + m_By_ValToCoord);    break;
-        case 3: d_ypos = (m_Ay_ValToCoord * j->host_expavg_credit + m_By_ValToCoord);   break;
-        default:d_ypos = (m_Ay_ValToCoord * j->user_total_credit + m_By_ValToCoord);    break;
-        }
+        d_xpos = (m_Ax_ValToCoord * j->x + m_Bx_ValToCoord);
+        d_ypos = (m_Ay_ValToCoord * j->y + m_By_ValToCoord);
 
         if (first_point) {
             if ((d_xpos < m_Graph_X_start) || (d_xpos > m_Graph_X_end) || 
@@ -1088,6 +1149,11 @@ void CPaintStatistics::DrawAll(wxDC &dc) {
     PROJECTS *proj = &(pDoc->statistics_status);
     wxASSERT(proj);
 
+    if (m_statistics_stamp != pDoc->GetStatisticsStamp()) {
+        m_statistics_stamp = pDoc->GetStatisticsStamp();
+        m_decimated.clear();
+    }
+
     m_WorkSpace_X_start = m_main_X_start;
     m_WorkSpace_X_end = m_main_X_end;
     m_WorkSpace_Y_start = m_main_Y_start;
@@ -1309,8 +1375,6 @@ void CPaintStatistics::DrawAll(wxDC &dc) {
             wxColour graphColour=wxColour(0,0,0);
             getDrawColour(graphColour,m_SelectedStatistic);
             DrawGraph(dc, i, graphColour, 0, m_SelectedStatistic);
-        //Draw marker
-            DrawMarker(dc);
             break;
         }
         break;
@@ -1380,8 +1444,6 @@ void CPaintStatistics::DrawAll(wxDC &dc) {
                 DrawGraph(dc, i, graphColour, typePoint, m_SelectedStatistic);
             }
         }
-    //Draw marker
-        DrawMarker(dc);
         break;
         }
     default:{
@@ -1396,29 +1458,43 @@ void CPaintStatistics::OnPaint(wxPaintEvent& WXUNUSED(event)) {
     wxMemoryDC mdc;
     wxCoord width = 0, height = 0;
     GetClientSize(&width, &height);
-    if (m_full_repaint){
-        if (!m_GraphZoomStart){
-            ClearXY();
-            ClearLegendXY();
-
-            m_main_X_start = 0.0;
-            if (width > 0) m_main_X_end = double(width); else m_main_X_end = 0.0;
-            m_main_Y_start = 0.0;
-            if (height > 0) m_main_Y_end = double(height); else m_main_Y_end = 0.0;
-
-            if (width < 1) width = 1;
-            if (height < 1) height = 1;
-            m_dc_bmp.Create(width, height);
+    const bool full_repaint = m_full_repaint;
+    if (m_full_repaint && !m_GraphZoomStart){
+        ClearXY();
+        ClearLegendXY();
+
+        m_main_X_start = 0.0;
+        if (width > 0) m_main_X_end = double(width); else m_main_X_end = 0.0;
+        m_main_Y_start = 0.0;
+        if (height > 0) m_main_Y_end = double(height); else m_main_Y_end = 0.0;
+
+        if (width < 1) width = 1;
+        if (height < 1) height = 1;
+        m_graph_bmp.Create(width, height);
+        mdc.SelectObject(m_graph_bmp);
+        DrawAll(mdc);
+        mdc.SelectObject(wxNullBitmap);
+        m_bmp_OK = true;
+        m_full_repaint = false;
+        m_overlay_repaint = true;
+    }
+    if (m_bmp_OK){
+    // Put the marker on a copy of the graphs
+        if (m_overlay_repaint && !m_GraphZoomStart){
+            if ((m_dc_bmp.GetWidth() != m_graph_bmp.GetWidth()) || (m_dc_bmp.GetHeight() != m_graph_bmp.GetHeight())){
+                m_dc_bmp.Create(m_graph_bmp.GetWidth(), m_graph_bmp.GetHeight());
+            }
+            wxMemoryDC gdc;
+            gdc.SelectObject(m_graph_bmp);
             mdc.SelectObject(m_dc_bmp);
-            DrawAll(mdc);
-            m_bmp_OK = true;
-            m_full_repaint = false;
-        }else if(m_bmp_OK){
+            mdc.Blit(0, 0, m_graph_bmp.GetWidth(), m_graph_bmp.GetHeight(), &gdc, 0, 0);
+            gdc.SelectObject(wxNullBitmap);
+            if ((1 == m_ModeViewStatistic) || (2 == m_ModeViewStatistic)) DrawMarker(mdc);
+            m_overlay_repaint = false;
+        }else{
             mdc.SelectObject(m_dc_bmp);
         }
-    }else{
-        if (m_bmp_OK){
-            mdc.SelectObject(m_dc_bmp);
+        if (!full_repaint){
             if (m_GraphZoomStart && (width == m_dc_bmp.GetWidth()) &&(height == m_dc_bmp.GetHeight())){
 
                 mdc.SetPen(wxPen(m_pen_ZoomRectColour , 1 , wxSOLID));
@@ -1543,7 +1619,7 @@ void CPaintStatistics::OnMouseMotion(wxMouseEvent& event) {
             }else{
                 m_GraphZoomStart = false;
 
-                m_full_repaint = true;
+                m_overlay_repaint = true;
                 Refresh(false);
             }
         }else if (m_GraphMoveStart){
@@ -1614,9 +1690,12 @@ void CPaintStatistics::OnLeftMouseUp(wxMouseEvent& event) {
                 }
                 m_GraphMarker1 = false;
                 m_Zoom_Auto = false;
+                m_full_repaint = true;
+            }else{
+            // Only the marker moved
+                m_overlay_repaint = true;
             }
             m_GraphZoomStart = false;
-            m_full_repaint = true;
             Refresh(false);
         }
         break;
@@ -1631,7 +1710,7 @@ void CPaintStatistics::OnRightMouseDown(wxMouseEvent& event) {
         if (m_GraphZoomStart){       //???
             m_GraphZoomStart = false;
             m_GraphMarker1 = false;
-            m_full_repaint = true;
+            m_overlay_repaint = true;
             Refresh(false);
         }else{
             wxClientDC dc (this);
@@ -1655,7 +1734,7 @@ void CPaintStatistics::OnRightMouseUp(wxMouseEvent& event) {
         m_GraphMoveGo = false;
     }else if (m_GraphMarker1){
         m_GraphMarker1 = false;
-        m_full_repaint = true;
+        m_overlay_repaint = true;
         Refresh(false);
     }else if (!m_Zoom_Auto){
         m_Zoom_Auto = true;
@@ -1668,7 +1747,7 @@ void CPaintStatistics::OnMouseLeaveWindows(wxMouseEvent& event) {
     if (m_GraphZoomStart){
         m_GraphMarker1 = false;
         m_GraphZoomStart = false;
-        m_full_repaint = true;
+        m_overlay_repaint = true;
         Refresh(false);
     }
     if (m_GraphMoveStart || m_GraphMoveGo){
@@ -2096,7 +2175,9 @@ bool CViewStatistics::OnRestoreState(wxConfigBase* pConfig) {
 }
 
 void CViewStatistics::OnListRender( wxTimerEvent& WXUNUSED(event) ) {
-    if (wxGetApp().GetDocument()->GetStatisticsCount()) {
+    CMainDocument* pDoc = wxGetApp().GetDocument();
+    if (pDoc->GetStatisticsCount() &&
+        (m_PaintStatistics->m_statistics_stamp != pDoc->GetStatisticsStamp())) {
         m_PaintStatistics->m_full_repaint = true;
         m_PaintStatistics->Refresh(false);
     }
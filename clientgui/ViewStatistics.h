@@ -19,8 +19,10 @@
 #ifndef _VIEWSTATISTICS_H_
 #define _VIEWSTATISTICS_H_
 
-#include <vector>
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <wx/window.h>
 #include <wx/bitmap.h>
@@ -47,6 +49,8 @@ public:
     void DrawAxis(wxDC &dc, const double max_val_y, const double min_val_y, const double max_val_x, const double min_val_x, wxColour pen_AxisColour, const double max_val_y_all, const double min_val_y_all);
     
     void DrawGraph(wxDC &dc, std::vector<PROJECT*>::const_iterator &i, const wxColour graphColour, const int typePoint, const int m_SelectedStatistic);
+
+    const std::vector<wxRealPoint>& GetDecimatedSeries(const PROJECT* project, const int statistic);
     
     void DrawMarker(wxDC &dc);
 
@@ -60,9 +64,25 @@ public:
 //--------------------------
     void DrawAll(wxDC &dc);
 //--------------------------
-    wxBitmap                m_dc_bmp;
-    bool                    m_full_repaint;
+    wxBitmap                m_dc_bmp;           ///< The graphs with the marker.
+    wxBitmap                m_graph_bmp;        ///< The graphs without the marker.
+    bool                    m_full_repaint;     ///< Draw the graphs again.
+    bool                    m_overlay_repaint;  ///< Only draw the marker again.
     bool                    m_bmp_OK;
+    unsigned long           m_statistics_stamp; ///< Stamp of the statistics in the bitmaps.
+// Decimated series
+    /// The points of a graph that can be seen at the current scale: for
+    /// each pixel column, the first, lowest, highest and last point.
+    struct DECIMATED_SERIES {
+        unsigned long stamp;
+        int statistic;
+        double ax;
+        double bx;
+        double x_start;
+        double x_end;
+        std::vector<wxRealPoint> points;
+    };
+    std::map<std::string, DECIMATED_SERIES> m_decimated; ///< By master URL.
 //
     int                     m_SelectedStatistic;
     int                     m_ModeViewStatistic;
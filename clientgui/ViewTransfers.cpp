@@ -47,6 +47,9 @@ CTransfer::CTransfer() {
     m_fTotalBytes = -1.0f;
     m_dTime = -1.0;
     m_dSpeed = -1.0;
+    m_ulStamp = 0;
+    m_bRetryCountdown = false;
+    m_bNeedFormat = true;
 }
 
 IMPLEMENT_DYNAMIC_CLASS(CViewTransfers, CTaskViewBase)
@@ -197,6 +200,7 @@ void CViewTransfers::OnTransfersRetryNow( wxCommandEvent& WXUNUSED(event) ) {
     wxASSERT(wxDynamicCast(pFrame, CAdvancedFrame));
 
     pFrame->UpdateStatusText(_("Retrying transfer now..."));
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -205,6 +209,7 @@ void CViewTransfers::OnTransfersRetryNow( wxCommandEvent& WXUNUSED(event) ) {
         
         pDoc->TransferRetryNow(m_iSortedIndexes[row]);
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     UpdateSelection();
@@ -234,6 +239,7 @@ void CViewTransfers::OnTransfersAbort( wxCommandEvent& WXUNUSED(event) ) {
 
     pFrame->UpdateStatusText(_("Aborting transfer..."));
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -261,6 +267,7 @@ void CViewTransfers::OnTransfersAbort( wxCommandEvent& WXUNUSED(event) ) {
         }
     }
     
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
 
     UpdateSelection();
@@ -277,6 +284,7 @@ wxString CViewTransfers::OnListGetItemText(long item, long column) const {
     wxString   strBuffer  = wxEmptyString;
 
     CTransfer* transfer = m_TransferCache.at(m_iSortedIndexes[item]);
+    FormatCacheItem(transfer);
     
     switch (column) {
         case COLUMN_PROJECT:
@@ -382,7 +390,7 @@ bool CViewTransfers::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnInde
             GetDocProgress(m_iSortedIndexes[iRowIndex], fDocumentFloat);
             if (fDocumentFloat != transfer->m_fProgress) {
                 transfer->m_fProgress = fDocumentFloat;
-                FormatProgress(fDocumentFloat, transfer->m_strProgress);
+                transfer->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -392,7 +400,7 @@ bool CViewTransfers::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnInde
             if ((fDocumentDouble != transfer->m_fBytesXferred) || (fDocumentDouble2 != transfer->m_fTotalBytes)) {
                 transfer->m_fBytesXferred = fDocumentDouble;
                 transfer->m_fTotalBytes = fDocumentDouble2;
-                FormatSize(fDocumentDouble, fDocumentDouble2, transfer->m_strSize);
+                transfer->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -400,7 +408,7 @@ bool CViewTransfers::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnInde
             GetDocTime(m_iSortedIndexes[iRowIndex], fDocumentDouble);
             if (fDocumentDouble != transfer->m_dTime) {
                 transfer->m_dTime = fDocumentDouble;
-                FormatTime(fDocumentDouble, transfer->m_strTime);
+                transfer->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -408,7 +416,7 @@ bool CViewTransfers::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnInde
             GetDocSpeed(m_iSortedIndexes[iRowIndex], fDocumentDouble);
             if (fDocumentDouble != transfer->m_dSpeed) {
                 transfer->m_dSpeed = fDocumentDouble;
-                FormatSpeed(fDocumentDouble, transfer->m_strSpeed);
+                transfer->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -424,6 +432,37 @@ bool CViewTransfers::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnInde
     return false;
 }
 
+/// The numbers are formatted when a row is drawn, see
+/// CViewWork::FormatCacheItem().
+void CViewTransfers::FormatCacheItem(CTransfer* transfer) const {
+    if (!transfer->m_bNeedFormat) return;
+    FormatProgress(transfer->m_fProgress, transfer->m_strProgress);
+    FormatSize(transfer->m_fBytesXferred, transfer->m_fTotalBytes, transfer->m_strSize);
+    FormatTime(transfer->m_dTime, transfer->m_strTime);
+    FormatSpeed(transfer->m_dSpeed, transfer->m_strSpeed);
+    transfer->m_bNeedFormat = false;
+}
+
+/// A transfer that waits for a retry is synchronized every time even if
+/// it didn't change, because its status counts down the time to the
+/// retry.
+bool CViewTransfers::UpdateCacheItemStamp(size_t iCacheIndex) {
+    CMainDocument* pDoc = wxGetApp().GetDocument();
+    CTransfer* transfer = m_TransferCache.at(iCacheIndex);
+    FILE_TRANSFER* ft = pDoc->file_transfer(iCacheIndex);
+    unsigned long stamp = pDoc->GetTransferStamp(iCacheIndex);
+
+    bool bRetryCountdown = ft && ((time_t)ft->next_request_time > wxDateTime::Now().GetTicks());
+    if (stamp && (stamp == transfer->m_ulStamp)
+        && !bRetryCountdown && !transfer->m_bRetryCountdown
+    ) {
+        return false;
+    }
+    transfer->m_ulStamp = stamp;
+    transfer->m_bRetryCountdown = bRetryCountdown;
+    return true;
+}
+
 void CViewTransfers::GetDocProjectName(size_t item, wxString& strBuffer) const {
     CMainDocument* pDoc = wxGetApp().GetDocument();
     FILE_TRANSFER* transfer = 0;
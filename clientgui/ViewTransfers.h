@@ -37,6 +37,9 @@ public:
  	wxString m_strSize;
  	wxString m_strTime;
  	wxString m_strSpeed;
+    unsigned long m_ulStamp;    ///< Change stamp of the synchronized transfer.
+    bool m_bRetryCountdown;     ///< The status shows the time until the next retry.
+    bool m_bNeedFormat;         ///< The numbers changed since they were formatted.
 };
 
 
@@ -68,6 +71,7 @@ protected:
     virtual wxInt32         GetCacheCount();
     virtual wxInt32         RemoveCacheElement();
     virtual bool            SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex);
+    virtual bool            UpdateCacheItemStamp(size_t iCacheIndex);
 
     virtual void            UpdateSelection();
 
@@ -85,6 +89,7 @@ protected:
     void                    GetDocSpeed(size_t item, double& fBuffer) const;
     wxInt32                 FormatSpeed(float fBuffer, wxString& strBuffer) const;
     void                    GetDocStatus(size_t item, wxString& strBuffer) const;
+    void                    FormatCacheItem(CTransfer* transfer) const;
 
     virtual double          GetProgressValue(long item);
 
@@ -58,6 +58,8 @@ CWork::CWork() {
     m_fProgress         = -1.0f;
     m_fTimeToCompletion = -1.0f;
     m_tReportDeadline   = (time_t)0;
+    m_ulStamp           = 0;
+    m_bNeedFormat       = true;
 }
 
 enum DlgButtons {
@@ -273,6 +275,7 @@ void CViewWork::OnWorkSuspend(wxCommandEvent& WXUNUSED(event)) {
     wxASSERT(m_pTaskPane);
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -289,6 +292,7 @@ void CViewWork::OnWorkSuspend(wxCommandEvent& WXUNUSED(event)) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
     
     UpdateSelection();
@@ -311,6 +315,7 @@ void CViewWork::OnWorkResume(wxCommandEvent& WXUNUSED(event)) {
     wxASSERT(m_pTaskPane);
     wxASSERT(m_pListPane);
 
+    pDoc->BeginBatch();
     row = -1;
     while (1) {
         // Step through all selected items
@@ -327,6 +332,7 @@ void CViewWork::OnWorkResume(wxCommandEvent& WXUNUSED(event)) {
             }
         }
     }
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxT(""));
     
     UpdateSelection();
@@ -396,6 +402,7 @@ void CViewWork::OnWorkAbort( wxCommandEvent& WXUNUSED(event) ) {
         buttons |= YesToAll | Cancel;
     }
 
+    pDoc->BeginBatch();
     int row = -1;
     while (1) {
         // Step through all selected items
@@ -404,6 +411,7 @@ void CViewWork::OnWorkAbort( wxCommandEvent& WXUNUSED(event) ) {
 
         if (!yesToAll) {
             CWork* work = m_WorkCache.at(m_iSortedIndexes.at(row));
+            FormatCacheItem(work);
 
             strMessage.Printf(_("Are you sure you want to abort task '%s'?\n"
                                 "(Progress: %s, Status: %s)"), work->m_strName.c_str(),
@@ -432,6 +440,7 @@ void CViewWork::OnWorkAbort( wxCommandEvent& WXUNUSED(event) ) {
         }
     }
 
+    pDoc->EndBatch();
     pFrame->UpdateStatusText(wxEmptyString);
 
     UpdateSelection();
@@ -471,6 +480,7 @@ wxString CViewWork::OnListGetItemText(long item, long column) const {
     wxString       strBuffer = wxEmptyString;
 
     CWork* work = m_WorkCache.at(m_iSortedIndexes.at(item));
+    FormatCacheItem(work);
 
     switch (column) {
         case COLUMN_PROJECT:
@@ -691,7 +701,7 @@ bool CViewWork::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex) {
             GetDocCPUTime(m_iSortedIndexes.at(iRowIndex), fDocumentFloat);
             if (fDocumentFloat != work->m_fCPUTime) {
                 work->m_fCPUTime = fDocumentFloat;
-                FormatCPUTime(fDocumentFloat, work->m_strCPUTime);
+                work->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -699,7 +709,7 @@ bool CViewWork::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex) {
             GetDocProgress(m_iSortedIndexes.at(iRowIndex), fDocumentFloat);
             if (fDocumentFloat != work->m_fProgress) {
                 work->m_fProgress = fDocumentFloat;
-                FormatProgress(fDocumentFloat, work->m_strProgress);
+                work->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -707,7 +717,7 @@ bool CViewWork::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex) {
             GetDocTimeToCompletion(m_iSortedIndexes.at(iRowIndex), fDocumentFloat);
             if (fDocumentFloat != work->m_fTimeToCompletion) {
                 work->m_fTimeToCompletion = fDocumentFloat;
-                FormatTimeToCompletion(fDocumentFloat, work->m_strTimeToCompletion);
+                work->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -715,7 +725,7 @@ bool CViewWork::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex) {
             GetDocReportDeadline(m_iSortedIndexes.at(iRowIndex), tDocumentTime);
             if (tDocumentTime != work->m_tReportDeadline) {
                 work->m_tReportDeadline = tDocumentTime;
-                FormatReportDeadline(tDocumentTime, work->m_strReportDeadline);
+                work->m_bNeedFormat = true;
                 return true;
             }
             break;
@@ -730,6 +740,25 @@ bool CViewWork::SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex) {
     return false;
 }
 
+/// Only rows that are drawn need their numbers as text, so the numbers
+/// are formatted when a row is drawn, not when they change.
+void CViewWork::FormatCacheItem(CWork* work) const {
+    if (!work->m_bNeedFormat) return;
+    FormatCPUTime(work->m_fCPUTime, work->m_strCPUTime);
+    FormatProgress(work->m_fProgress, work->m_strProgress);
+    FormatTimeToCompletion(work->m_fTimeToCompletion, work->m_strTimeToCompletion);
+    FormatReportDeadline(work->m_tReportDeadline, work->m_strReportDeadline);
+    work->m_bNeedFormat = false;
+}
+
+bool CViewWork::UpdateCacheItemStamp(size_t iCacheIndex) {
+    unsigned long stamp = wxGetApp().GetDocument()->GetResultStamp(iCacheIndex);
+    CWork* work = m_WorkCache.at(iCacheIndex);
+    if (stamp && stamp == work->m_ulStamp) return false;
+    work->m_ulStamp = stamp;
+    return true;
+}
+
 void CViewWork::GetDocProjectName(size_t item, wxString& strBuffer) const {
     CMainDocument* doc = wxGetApp().GetDocument();
     RESULT* result = wxGetApp().GetDocument()->result(item);
@@ -41,6 +41,8 @@ public:
  	wxString m_strProgress;
  	wxString m_strTimeToCompletion;
  	wxString m_strReportDeadline;
+    unsigned long m_ulStamp;    ///< Change stamp of the synchronized result.
+    bool m_bNeedFormat;         ///< The numbers changed since they were formatted.
 };
 
 class DlgYesToAll: public wxDialog {
@@ -89,6 +91,7 @@ protected:
     virtual wxInt32         GetCacheCount();
     virtual wxInt32         RemoveCacheElement();
     virtual bool            SynchronizeCacheItem(wxInt32 iRowIndex, wxInt32 iColumnIndex);
+    virtual bool            UpdateCacheItemStamp(size_t iCacheIndex);
     virtual void            UpdateSelection();
 
     virtual void            DemandLoadView();
@@ -106,6 +109,7 @@ protected:
     wxInt32                 FormatReportDeadline(time_t deadline, wxString& strBuffer) const;
     void                    GetDocStatus(size_t item, wxString& strBuffer) const;
     wxInt32                 FormatStatus(wxInt32 item, wxString& strBuffer) const;
+    void                    FormatCacheItem(CWork* work) const;
 
     virtual double          GetProgressValue(long item);
 
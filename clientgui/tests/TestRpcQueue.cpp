@@ -0,0 +1,128 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for the bookkeeping of the Manager's RPC thread.
+
+#include <UnitTest++.h>
+
+#include "clientgui/RpcQueue.h"
+
+SUITE(TestRpcQueue)
+{
+    /// A refresh goes through its states once, and requests made
+    /// meanwhile are coalesced with it.
+    TEST(RefreshCycle)
+    {
+        CRpcRefreshQueue queue;
+        RPC_REFRESH what;
+        int seqno = 0;
+        int retval = 0;
+
+        CHECK(!queue.Start(what, seqno));
+        CHECK(queue.Request(RPC_REFRESH_MESSAGES, 42));
+        CHECK(queue.IsPending(RPC_REFRESH_MESSAGES));
+        CHECK(!queue.Request(RPC_REFRESH_MESSAGES, 43));
+
+        CHECK(queue.Start(what, seqno));
+        CHECK_EQUAL(RPC_REFRESH_MESSAGES, what);
+        CHECK_EQUAL(42, seqno);
+        CHECK(!queue.Start(what, seqno));
+        CHECK(!queue.TakeDone(RPC_REFRESH_MESSAGES, retval));
+        CHECK(!queue.Request(RPC_REFRESH_MESSAGES, 43));
+
+        queue.Finish(RPC_REFRESH_MESSAGES, -5);
+        CHECK(!queue.IsPending(RPC_REFRESH_MESSAGES));
+        // The buffer isn't given back before the reply is taken.
+        CHECK(!queue.Request(RPC_REFRESH_MESSAGES, 43));
+        CHECK(queue.TakeDone(RPC_REFRESH_MESSAGES, retval));
+        CHECK_EQUAL(-5, retval);
+        CHECK(!queue.TakeDone(RPC_REFRESH_MESSAGES, retval));
+        CHECK(queue.Request(RPC_REFRESH_MESSAGES, 43));
+    }
+
+    /// After a new connection, the reply of a running refresh is thrown
+    /// away, and a new request for it is run again.
+    TEST(DropOnNewConnection)
+    {
+        CRpcRefreshQueue queue;
+        RPC_REFRESH what;
+        int seqno = 0;
+        int retval = 0;
+
+        CHECK(queue.Request(RPC_REFRESH_STATE, 0));
+        CHECK(queue.Request(RPC_REFRESH_RESULTS, 0));
+        CHECK(queue.Request(RPC_REFRESH_CC_STATUS, 0));
+        CHECK(queue.Start(what, seqno));
+        CHECK_EQUAL(RPC_REFRESH_STATE, what);
+        CHECK(queue.Start(what, seqno));
+        CHECK_EQUAL(RPC_REFRESH_CC_STATUS, what);
+        queue.Finish(RPC_REFRESH_CC_STATUS, 0);
+
+        queue.Drop();
+        CHECK(!queue.IsPending(RPC_REFRESH_STATE));
+        CHECK(!queue.IsPending(RPC_REFRESH_RESULTS));
+        CHECK(!queue.TakeDone(RPC_REFRESH_CC_STATUS, retval));
+
+        // Asked again while the stale one is still running.
+        CHECK(queue.Request(RPC_REFRESH_STATE, 0));
+        CHECK(queue.IsPending(RPC_REFRESH_STATE));
+        CHECK(!queue.Start(what, seqno));
+        queue.Finish(RPC_REFRESH_STATE, 0);
+        CHECK(!queue.TakeDone(RPC_REFRESH_STATE, retval));
+
+        CHECK(queue.Start(what, seqno));
+        CHECK_EQUAL(RPC_REFRESH_STATE, what);
+        queue.Finish(RPC_REFRESH_STATE, 0);
+        CHECK(queue.TakeDone(RPC_REFRESH_STATE, retval));
+
+        // A stale refresh that wasn't asked for again just ends.
+        CHECK(queue.Request(RPC_REFRESH_DISK_USAGE, 0));
+        CHECK(queue.Start(what, seqno));
+        queue.Drop();
+        queue.Finish(RPC_REFRESH_DISK_USAGE, 0);
+        CHECK(!queue.TakeDone(RPC_REFRESH_DISK_USAGE, retval));
+        CHECK(queue.Request(RPC_REFRESH_DISK_USAGE, 0));
+    }
+
+    TEST(RetryBackoff)
+    {
+        CRpcRetry retry(1, 8);
+        CHECK(retry.Due(100));
+
+        retry.Failed(100);
+        CHECK(!retry.Due(100.5));
+        CHECK(retry.Due(101));
+        CHECK_CLOSE(0.5, retry.Remaining(100.5), 1e-9);
+
+        retry.Failed(101);
+        CHECK(!retry.Due(102.5));
+        CHECK(retry.Due(103));
+        retry.Failed(103);
+        retry.Failed(107);
+        CHECK(retry.Due(115));
+        retry.Failed(115);
+        CHECK(!retry.Due(122));
+        CHECK(retry.Due(123));
+        CHECK_CLOSE(0, retry.Remaining(124), 1e-9);
+
+        retry.Reset();
+        CHECK(retry.Due(0));
+        retry.Failed(200);
+        CHECK(retry.Due(201));
+    }
+}
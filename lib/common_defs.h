@@ -223,6 +223,11 @@ struct VERSION_INFO {
 #define ASSIGNED_WU_STR "asgn"
 #define GUI_RPC_PASSWD_FILE "gui_rpc_auth.cfg"
 
+/// Unix domain socket for GUI RPCs in the data directory. Clients
+/// connect to it with the host name "unix:" followed by its path.
+#define GUI_RPC_SOCKET_FILE "gui_rpc.sock"
+#define GUI_RPC_UNIX_PREFIX "unix:"
+
 /// Used for suppressing compiler warnings for unused parameters.
 #define SYNEC_UNUSED(param)
 
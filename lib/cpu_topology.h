@@ -0,0 +1,132 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Host CPU topology (packages, cores, SMT siblings, NUMA nodes, L3 domains)
+/// and a placement engine that assigns tasks to CPU sets.
+
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+/// A logical CPU (hardware thread) as seen by the OS.
+struct LOGICAL_CPU {
+    int id;         ///< OS CPU number.
+    int package;    ///< Physical package (socket) ID.
+    int core;       ///< Index of the physical core, unique across the host.
+    int numa_node;  ///< NUMA node, 0 if the host isn't NUMA.
+    int l3_domain;  ///< Lowest CPU number sharing this CPU's last-level cache.
+};
+
+/// Topology of the host's CPUs.
+class CPU_TOPOLOGY {
+public:
+    std::vector<LOGICAL_CPU> cpus; ///< Sorted by CPU number.
+    int npackages;
+    int ncores;
+    int nnodes;
+    int nllc_domains;   ///< Number of distinct LOGICAL_CPU::l3_domain values.
+    double llc_size;    ///< Size of one L3 cache (the smallest) in bytes, 0 if unknown.
+
+    CPU_TOPOLOGY();
+    void clear();
+
+    /// Read the topology from a sysfs tree.
+    int parse(const std::string& sysfs_root = "/sys");
+
+    /// Return the index into #cpus of the given CPU number, or -1.
+    int index_of(int cpu_id) const;
+};
+
+/// The CPUs and NUMA node assigned to a task.
+struct CPU_PLACEMENT {
+    std::vector<int> cpus;  ///< OS CPU numbers, sorted.
+    int numa_node;          ///< Preferred memory node, -1 if none.
+
+    CPU_PLACEMENT(): numa_node(-1) {}
+    void clear();
+    bool empty() const {
+        return cpus.empty();
+    }
+
+    /// Return the CPU set in sysfs list notation, e.g. "0-3,8".
+    std::string cpu_list() const;
+};
+
+/// Assigns tasks to CPUs, keeping track of which CPUs are in use.
+///
+/// Tasks are identified by an arbitrary integer key (the client uses the
+/// slot number). Whole idle cores are preferred over SMT siblings of busy
+/// cores, and all CPUs of a task are kept on one NUMA node and, as far as
+/// possible, one L3 domain.
+class CPU_PLACER {
+public:
+    CPU_PLACER();
+
+    void init(const CPU_TOPOLOGY& topology);
+    bool enabled() const {
+        return !topology.cpus.empty();
+    }
+
+    /// Assign \a ncpus CPUs to the task \a key.
+    bool place(int key, double ncpus, CPU_PLACEMENT& placement);
+
+    /// Return the CPUs of the task \a key to the pool.
+    void release(int key);
+
+    /// Number of CPUs not assigned to any task.
+    int nfree() const;
+
+private:
+    CPU_TOPOLOGY topology;
+    std::vector<int> owner; ///< Task key for each entry of topology.cpus, -1 if free.
+
+    bool core_idle(int core) const;
+    int pick_node(int ncpus, bool whole_cores) const;
+    void take(int node, int ncpus, bool whole_cores, int key, std::vector<int>& chosen);
+};
+
+/// Parse a sysfs CPU list ("0-3,8,10-11").
+int parse_cpu_list(const std::string& str, std::vector<int>& cpus);
+
+/// Bind all threads of process \a pid (0 for the calling thread) to the
+/// given CPUs. The threads are listed again until no new one shows up,
+/// so threads started while binding are bound too.
+int set_cpu_affinity(int pid, const CPU_PLACEMENT& placement);
+
+/// The CPU and NUMA node masks of a placement, built beforehand so that
+/// the child of fork() can bind itself before exec(), where it must not
+/// allocate memory. The binding and the memory policy belong to the
+/// calling thread and are inherited by the threads it starts.
+struct CPU_BINDING {
+    std::vector<unsigned long> cpu_mask;    ///< Empty if not bound.
+    std::vector<unsigned long> node_mask;   ///< Empty if no preferred node.
+
+    explicit CPU_BINDING(const CPU_PLACEMENT& placement);
+
+    /// Bind the calling thread to the CPUs. Only makes a system call.
+    int set_affinity() const;
+
+    /// Make the calling thread prefer memory from the NUMA node; the
+    /// kernel falls back to other nodes when it runs out.
+    /// Only makes a system call.
+    int set_numa_preference() const;
+};
+
+#endif // CPU_TOPOLOGY_H
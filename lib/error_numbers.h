@@ -187,6 +187,10 @@
 #define ERR_DB_CONN_LOST    -230
 #define ERR_CRYPTO          -231
 #define ERR_UNSTARTED_LATE  -233
+#define ERR_AFFINITY        -234
+#define ERR_PERF_EVENT      -235
+#define ERR_DECOMPRESS      -236
+#define ERR_PERF_EVENT_DENIED -237
 
 // PLEASE: add a text description of your error to
 // the text description function boincerror() in str_util.C.
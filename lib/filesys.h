@@ -46,6 +46,21 @@ FILE* boinc_fopen(const char* path, const char* mode);
 /// Copy a file.
 int boinc_copy(const char* orig, const char* newf);
 
+/// Ways in which boinc_stage_file() can make a copy of a file.
+enum STAGE_METHOD {
+    STAGE_CLONE,        ///< Reflink sharing the data blocks of the file.
+    STAGE_LINK,         ///< Hard link to the file.
+    STAGE_COPY_RANGE,   ///< Copy done by the kernel with copy_file_range().
+    STAGE_SENDFILE,     ///< Copy done by the kernel with sendfile().
+    STAGE_BUFFERED      ///< Copy through a buffer.
+};
+
+/// Name of a way to copy a file, for messages.
+const char* stage_method_name(STAGE_METHOD method);
+
+/// Make a copy of a file for a task, as cheaply as possible.
+int boinc_stage_file(const char* src, const char* dst, bool allow_link, STAGE_METHOD& method);
+
 /// Rename a file.
 int boinc_rename(const char* old, const char* newf);
 
@@ -77,6 +92,9 @@ int is_dir(const char* path);
 /// Check if the given path denotes a symbolic link.
 int is_symlink(const char* path);
 
+/// Check if a directory has no entries.
+bool is_dir_empty(const std::string& path);
+
 /// Truncate the size of a file.
 int boinc_truncate(const char* path, double size);
 
@@ -28,8 +28,10 @@
 #include <netinet/in.h>
 #endif
 
-#include <vector>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "miofile.h"
 #include "prefs.h"
@@ -222,6 +224,13 @@ public:
     bool edf_scheduled;
     std::string graphics_exec_path;
     std::string slot_path;
+    std::string cpu_set;    ///< CPUs the task is bound to, e.g. "0-3".
+    int numa_node;          ///< NUMA node the task prefers, -1 if none.
+    double ipc;             ///< Instructions per cycle, if counted.
+    double llc_mpki;        ///< Last-level cache misses per 1000 instructions.
+    double stall_fraction;  ///< Fraction of cycles stalled.
+    double launch_time;     ///< Seconds the client took to start the task, 0 if unknown.
+    unsigned long long xml_hash;    ///< Hash of the XML this was parsed from, 0 if unknown.
 
     APP* app;
     WORKUNIT* wup;
@@ -235,6 +244,44 @@ public:
     void clear();
 };
 
+/// Hardware performance counters of a task.
+class TASK_HW_COUNTERS {
+public:
+    std::string name;
+    std::string project_url;
+
+    // totals over the lifetime of the task
+    double instructions;
+    double cycles;
+    double llc_misses;
+    double stalled_cycles;
+
+    // during the last sampling interval
+    double ipc;
+    double llc_mpki;
+    double stall_fraction;
+
+    TASK_HW_COUNTERS();
+
+    int parse(MIOFILE& in);
+    void print() const;
+    void clear();
+};
+
+/// One value of a metric of the client.
+class METRIC_VALUE {
+public:
+    std::string name;
+    std::string labels; ///< Label set in the Prometheus format, e.g. state="new".
+    double value;
+
+    METRIC_VALUE();
+
+    int parse(MIOFILE& in);
+    void print() const;
+    void clear();
+};
+
 class FILE_TRANSFER {
 public:
     std::string name;
@@ -256,6 +303,7 @@ public:
     double file_offset;
     double xfer_speed;
     std::string hostname;
+    unsigned long long xml_hash;    ///< Hash of the XML this was parsed from, 0 if unknown.
     PROJECT* project;
 
     FILE_TRANSFER();
@@ -305,6 +353,53 @@ public:
     void clear();
 };
 
+/// Objects of a list kept after the list is cleared, so that the next
+/// refresh of the list can fill them in again instead of allocating
+/// new ones.
+template <class T>
+class SPARE_LIST {
+public:
+    SPARE_LIST() {}
+    ~SPARE_LIST() {
+        free_unused();
+    }
+
+    /// Return a cleared object, reusing a kept one if there is one.
+    T* get() {
+        if (spare.empty()) return new T();
+        T* p = spare.back();
+        spare.pop_back();
+        p->clear();
+        return p;
+    }
+
+    /// Keep the objects of \a v and empty it. Kept objects that weren't
+    /// reused since the last call are deleted, so that no more objects
+    /// are kept than the list had.
+    void recycle(std::vector<T*>& v) {
+        free_unused();
+        spare.assign(v.begin(), v.end());
+        v.clear();
+    }
+
+private:
+    std::vector<T*> spare;
+
+    void free_unused() {
+        for (size_t i=0; i<spare.size(); i++) {
+            delete spare[i];
+        }
+        spare.clear();
+    }
+
+    SPARE_LIST(const SPARE_LIST&);
+    SPARE_LIST& operator=(const SPARE_LIST&);
+};
+
+/// The state of the client as returned by RPC_CLIENT::get_state().
+///
+/// The lookup functions use indices that are built while parsing, so
+/// the lists must not be changed other than by parse() and clear().
 class CC_STATE {
 public:
     std::vector<PROJECT*> projects;
@@ -330,8 +425,31 @@ public:
     RESULT* lookup_result(const std::string& project_url, const std::string& name);
     RESULT* lookup_result(const PROJECT* project, const std::string& name);
 
+    /// Parse the contents of a \<client_state\> element and add the
+    /// items to the lists.
+    int parse(MIOFILE& in);
     void print() const;
     void clear();
+
+    /// Exchange the contents with those of \a other.
+    /// The objects kept for reuse by clear() aren't exchanged.
+    void swap(CC_STATE& other);
+
+private:
+    typedef std::pair<const PROJECT*, std::string> NAME_KEY;
+    typedef std::pair<NAME_KEY, int> VERSION_KEY;
+
+    std::map<std::string, PROJECT*> project_index;
+    std::map<NAME_KEY, APP*> app_index;
+    std::map<VERSION_KEY, APP_VERSION*> app_version_index;
+    std::map<NAME_KEY, WORKUNIT*> wu_index;
+    std::map<NAME_KEY, RESULT*> result_index;
+
+    SPARE_LIST<PROJECT> spare_projects;
+    SPARE_LIST<APP> spare_apps;
+    SPARE_LIST<APP_VERSION> spare_app_versions;
+    SPARE_LIST<WORKUNIT> spare_wus;
+    SPARE_LIST<RESULT> spare_results;
 };
 
 class ALL_PROJECTS_LIST {
@@ -347,6 +465,7 @@ public:
 class PROJECTS {
 public:
     std::vector<PROJECT*> projects;
+    SPARE_LIST<PROJECT> spare;
 
     PROJECTS(){}
     ~PROJECTS();
@@ -372,6 +491,7 @@ struct DISK_USAGE {
 class RESULTS {
 public:
     std::vector<RESULT*> results;
+    SPARE_LIST<RESULT> spare;
 
     RESULTS(){}
     ~RESULTS();
@@ -380,6 +500,25 @@ public:
     void clear();
 };
 
+class HW_COUNTERS_LIST {
+public:
+    std::vector<TASK_HW_COUNTERS*> tasks;
+
+    HW_COUNTERS_LIST(){}
+    ~HW_COUNTERS_LIST();
+
+    void print() const;
+    void clear();
+};
+
+class METRICS {
+public:
+    std::vector<METRIC_VALUE> metrics;
+
+    void print() const;
+    void clear();
+};
+
 class FILE_TRANSFERS {
 public:
     std::vector<FILE_TRANSFER*> file_transfers;
@@ -402,6 +541,24 @@ public:
     void clear();
 };
 
+/// Which messages RPC_CLIENT::get_messages() asks for, besides those
+/// newer than a sequence number. Core clients before the filter was
+/// added ignore it and send all newer messages, oldest first.
+struct MESSAGE_FILTER {
+    bool by_project;        ///< If true, only messages of #project.
+    std::string project;    ///< Project name, or empty for messages not about a project.
+    int min_priority;       ///< Only messages with at least this priority.
+    int before_seqno;       ///< If not zero, only messages older than this.
+    int max_count;          ///< If not zero, at most this many messages.
+
+    /// Send the newest messages first, and keep the newest ones if there
+    /// are more than #max_count.
+    bool newest_first;
+
+    MESSAGE_FILTER();
+    void clear();
+};
+
 struct DISPLAY_INFO {
     std::string window_station;   // windows
     std::string desktop;          // windows
@@ -534,6 +691,31 @@ struct SIMPLE_GUI_INFO {
     void print() const;
 };
 
+/// Result, project and file transfer operations to be sent in one RPC
+/// with RPC_CLIENT::do_batch(). The operations are the same as those of
+/// RPC_CLIENT::result_op(), RPC_CLIENT::project_op() and
+/// RPC_CLIENT::file_transfer_op(), and change the given objects in the
+/// same way when they are added.
+class RPC_BATCH {
+public:
+    /// \return Zero on success, -1 if \a op is not known.
+    int result_op(RESULT& result, const char* op);
+    int project_op(PROJECT& project, const char* op);
+    int file_transfer_op(const FILE_TRANSFER& ft, const char* op);
+
+    size_t size() const { return requests.size(); }
+    void clear();
+
+    /// The result of each operation, in the order they were added,
+    /// filled in by RPC_CLIENT::do_batch().
+    std::vector<int> retvals;
+
+private:
+    std::vector<std::string> requests;
+
+    friend class RPC_CLIENT;
+};
+
 class RPC_CLIENT {
 public:
     int sock;
@@ -542,6 +724,11 @@ public:
     bool retry;
     sockaddr_in addr;
 
+    /// If true, the contents of the reply to each RPC are kept in
+    /// #last_reply, for tools that show the reply as it was sent.
+    bool keep_reply;
+    std::string last_reply;
+
     /// Send a rpc-request to the rpc-server.
     int send_request(const char* p);
 
@@ -554,18 +741,37 @@ public:
     /// Initiate a connection to the core client.
     int init(const char* host, int port = GUI_RPC_PORT);
 
+    /// Connect to the Unix domain socket at #unix_path.
+    int connect_unix();
+
     /// Initiate a connection to the core client using non-blocking operations.
     int init_asynch(const char* host, double timeout, bool retry, int port = GUI_RPC_PORT);
 
     int init_poll();
     void close();
 
+    /// Path of the Unix domain socket if the host name passed to init()
+    /// or init_asynch() was "unix:" followed by a path, otherwise empty.
+    std::string unix_path;
+
+    /// Encoding of large replies agreed on in exchange_versions(), or
+    /// empty if all replies are plain. See gui_rpc_encoding.h.
+    std::string reply_encoding;
+
+    /// 1 if the core client knows batches, 0 if not, -1 if do_batch()
+    /// didn't ask yet.
+    int batch_support;
+
     /// Answer an authorization request sent by the server.
     int authorize(const char* passwd);
 
+    /// Exchange version numbers with the core client. Unless connected by
+    /// a Unix domain socket, also ask for compression of large replies.
     int exchange_versions(VERSION_INFO& server);
     int get_state(CC_STATE& state);
     int get_results(RESULTS& t);
+    int get_hw_counters(HW_COUNTERS_LIST& l);
+    int get_metrics(METRICS& m);
     int get_file_transfers(FILE_TRANSFERS& t);
     int get_simple_gui_info(SIMPLE_GUI_INFO& sgi);
     int get_simple_gui_info(CC_STATE& state, RESULTS& results);
@@ -588,14 +794,32 @@ public:
     int set_proxy_settings(const GR_PROXY_INFO& pi);
     int get_proxy_settings(GR_PROXY_INFO& pi);
     int get_messages(int seqno, MESSAGES& msgs);
+
+    /// Get the messages newer than \a seqno that pass \a filter, and
+    /// append them to \a msgs in the order they were sent.
+    int get_messages(int seqno, MESSAGES& msgs, const MESSAGE_FILTER& filter);
     int get_message_count(int& msg_count);
     int file_transfer_op(const FILE_TRANSFER& ft, const char* op);
     int result_op(RESULT& result, const char* op);
+
+    /// Do all operations of \a batch in one RPC, and store the result of
+    /// each in RPC_BATCH::retvals. Core clients without batches get the
+    /// operations one by one.
+    ///
+    /// \return Zero if the batch was done, even if some operations
+    ///         failed, otherwise an error code.
+    int do_batch(RPC_BATCH& batch);
+
     int get_host_info(HOST_INFO& host);
     int quit();
     int acct_mgr_info(ACCT_MGR_INFO& ami);
     const char* mode_name(int mode);
     int get_statistics(PROJECTS& p);
+
+    /// Get the statistics between \a begin and \a end (0 for no limit),
+    /// with at most \a max_points days per project (0 for all days).
+    int get_statistics(PROJECTS& p, double begin, double end, int max_points);
+
     int network_available();
     int get_project_init_status(PROJECT_INIT_STATUS& pis);
 
@@ -626,6 +850,7 @@ public:
 #endif
     int read_global_prefs_override();
     int read_cc_config();
+    int dump_trace();
     int get_cc_status(CC_STATUS& status);
     int get_global_prefs_file(std::string&);
     int get_global_prefs_working(std::string&);
@@ -637,6 +862,15 @@ public:
     int set_debts(const std::vector<PROJECT>&);
 };
 
+/// \name Parsers for the contents of replies
+/// Used by RPC_CLIENT and by RPC_FLEET. \a fin must be at the start of
+/// the reply. They don't change the locale; use SET_LOCALE.
+/// @{
+int parse_cc_status_reply(MIOFILE& fin, CC_STATUS& status);
+int parse_results_reply(MIOFILE& fin, RESULTS& results);
+int parse_project_status_reply(MIOFILE& fin, PROJECTS& projects);
+/// @}
+
 struct RPC {
     char* mbuf;
     MIOFILE fin;
@@ -648,15 +882,16 @@ struct RPC {
     int parse_reply();
 };
 
+/// Use the "C" locale while an RPC is done.
+/// Where uselocale() exists only the calling thread is switched, so that
+/// RPCs can be done in several threads at once.
 struct SET_LOCALE {
-    std::string locale;
-    inline SET_LOCALE() {
-        locale = setlocale(LC_ALL, NULL);
-        setlocale(LC_ALL, "C");
-    }
-    inline ~SET_LOCALE() {
-        setlocale(LC_ALL, locale.c_str());
-    }
+    SET_LOCALE();
+    ~SET_LOCALE();
+
+private:
+    std::string locale;     ///< Previous global locale, if setlocale() was used.
+    void* old_locale;       ///< Previous locale of the thread, if uselocale() was used.
 };
 
 std::string read_gui_rpc_password(const std::string& file_name = GUI_RPC_PASSWD_FILE);
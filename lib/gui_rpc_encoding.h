@@ -0,0 +1,86 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Compressed encoding of GUI RPC replies.
+///
+/// A GUI RPC client that can decode compressed replies lists the
+/// encodings it accepts in exchange_versions, and the core client names
+/// the one it picked in its reply. From then on, replies longer than
+/// GUI_RPC_COMPRESS_THRESHOLD may be sent as
+///
+///     \\002zlib <length>\\n<length bytes of zlib data>
+///
+/// where the data decompresses to the plain reply, including the final
+/// \\003. Plain replies start with '<', so both can be told apart.
+/// Clients that don't ask for an encoding only get plain replies.
+
+#ifndef GUI_RPC_ENCODING_H
+#define GUI_RPC_ENCODING_H
+
+#include <string>
+
+class MFILE;
+struct z_stream_s;
+
+#define GUI_RPC_ENCODING_ZLIB "zlib"
+
+/// First byte of an encoded reply.
+const char GUI_RPC_ENCODED_MARK = '\002';
+
+/// Shorter replies are not worth compressing.
+const size_t GUI_RPC_COMPRESS_THRESHOLD = 16384;
+
+/// Check if \a encoding is one that encode_gui_rpc_reply() can produce.
+bool gui_rpc_encoding_supported(const std::string& encoding);
+
+/// Encode the reply \a plain with \a encoding, including the header.
+///
+/// \return Zero on success, ERR_INVALID_PARAM if the encoding is not
+///         supported, ERR_MALLOC if compressing failed.
+int encode_gui_rpc_reply(const std::string& plain, const std::string& encoding, std::string& out);
+
+/// Decodes an encoded reply piece by piece, as it is received.
+class GUI_RPC_DECODER {
+public:
+    GUI_RPC_DECODER();
+    ~GUI_RPC_DECODER();
+
+    /// Decode the next \a len bytes of the reply and append the
+    /// decompressed data to \a out. Bytes after the end of the reply
+    /// are ignored.
+    ///
+    /// \return Zero on success, ERR_DECOMPRESS if the header or the
+    ///         compressed data is not valid.
+    int feed(const char* data, size_t len, MFILE& out);
+
+    /// Check if the whole reply was decoded.
+    bool done() const { return header_done && !remaining; }
+
+private:
+    std::string header;
+    bool header_done;
+    size_t remaining;       ///< Compressed bytes not yet received.
+    z_stream_s* stream;
+
+    int parse_header();
+
+    GUI_RPC_DECODER(const GUI_RPC_DECODER&);
+    GUI_RPC_DECODER& operator=(const GUI_RPC_DECODER&);
+};
+
+#endif // GUI_RPC_ENCODING_H
@@ -0,0 +1,150 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// GUI RPCs to many clients at once from a single thread.
+///
+/// RPC_CLIENT waits for each reply, so talking to hundreds of clients
+/// needs hundreds of threads or takes a long time. RPC_FLEET keeps a
+/// non-blocking connection to each host and waits for all of them at
+/// once with epoll(), or poll() where epoll isn't available.
+///
+/// Each host goes through the states of FLEET_HOST_STATE. An error or
+/// timeout closes the connection and fails the RPCs queued for the host;
+/// the connection is opened again after a delay that doubles after each
+/// failure, up to a maximum.
+
+#ifndef GUI_RPC_FLEET_H
+#define GUI_RPC_FLEET_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "gui_rpc_client.h"
+
+class FLEET_HOST;
+
+/// An RPC done by RPC_FLEET. Derived classes parse the reply, usually
+/// with one of the parse_*_reply() functions, and act on it in done().
+class FLEET_RPC {
+public:
+    virtual ~FLEET_RPC() {}
+
+    /// The request, without the <boinc_gui_rpc_request> element.
+    virtual const char* request() const = 0;
+
+    /// Parse the reply, in the "C" locale.
+    virtual int parse(MIOFILE& fin) = 0;
+
+    /// Called with the result of parse(), or with the error if the RPC
+    /// failed. The RPC is deleted afterwards.
+    virtual void done(FLEET_HOST& host, int retval) = 0;
+};
+
+enum FLEET_HOST_STATE {
+    FLEET_WAITING,          ///< Not connected; waits until the next attempt.
+    FLEET_CONNECTING,
+    FLEET_AUTHORIZING,      ///< Doing auth1 or auth2.
+    FLEET_READY,            ///< Connected, no RPC in progress.
+    FLEET_BUSY              ///< Connected, doing an RPC.
+};
+
+/// A client polled by RPC_FLEET.
+class FLEET_HOST {
+public:
+    const std::string& get_name() const { return name; }
+    int get_port() const { return port; }
+    FLEET_HOST_STATE get_state() const { return state; }
+
+    /// Number of RPCs queued or in progress.
+    size_t pending() const { return queue.size(); }
+
+    int last_error;         ///< Error that closed the last connection.
+    int nconnects;          ///< Connections that were authorized.
+    int nreplies;           ///< RPCs that got a reply.
+    int nerrors;            ///< RPCs that failed.
+    double rpc_time;        ///< Total time from request to reply.
+
+private:
+    friend class RPC_FLEET;
+
+    FLEET_HOST(const std::string& host_name, int host_port, const std::string& passwd);
+
+    std::string name;
+    int port;
+    std::string password;
+    RPC_CLIENT rpc;             ///< Only its socket and address are used.
+    FLEET_HOST_STATE state;
+    bool auth2;                 ///< In FLEET_AUTHORIZING: auth1 is done.
+    double backoff;             ///< Delay before the next connection attempt.
+    double deadline;            ///< Timeout of the current step, or time of the next attempt.
+    double start_time;          ///< When the current RPC was sent.
+    std::deque<FLEET_RPC*> queue;
+    std::string out;            ///< Request being sent.
+    size_t out_pos;             ///< Bytes of #out already sent.
+    std::string in;             ///< Reply received so far.
+    int events;                 ///< Events the poller waits for.
+};
+
+class RPC_FLEET {
+public:
+    /// \param[in] timeout Time allowed for connecting, authorizing and
+    ///                    for each RPC, in seconds.
+    /// \param[in] min_backoff Delay after the first failure.
+    /// \param[in] max_backoff Longest delay between connection attempts.
+    RPC_FLEET(double timeout = 30, double min_backoff = 1, double max_backoff = 300);
+    ~RPC_FLEET();
+
+    /// Set up the poller. Must be called before anything else.
+    int init();
+
+    /// Add a host; its connection is opened by the next poll().
+    /// An empty \a password skips authorization.
+    FLEET_HOST* add_host(const std::string& name, int port, const std::string& password);
+
+    const std::vector<FLEET_HOST*>& get_hosts() const { return hosts; }
+
+    /// Queue \a rpc for \a host. RPC_FLEET owns \a rpc from now on.
+    void submit(FLEET_HOST* host, FLEET_RPC* rpc);
+
+    /// Wait at most \a max_wait seconds for the sockets, and advance the
+    /// hosts that are ready or whose step timed out. The callbacks of
+    /// the RPCs are called from here.
+    ///
+    /// \return Zero, or ERR_SELECT if waiting failed.
+    int poll(double max_wait);
+
+private:
+    double timeout;
+    double min_backoff;
+    double max_backoff;
+    int epoll_fd;               ///< -1 if poll() is used.
+    std::vector<FLEET_HOST*> hosts;
+
+    void start_connect(FLEET_HOST& host, double now);
+    void fail(FLEET_HOST& host, int error, double now);
+    void send_next(FLEET_HOST& host, double now);
+    void start_send(FLEET_HOST& host, const std::string& request, double now);
+    void handle_writable(FLEET_HOST& host, double now);
+    void handle_readable(FLEET_HOST& host, double now);
+    void handle_reply(FLEET_HOST& host, double now);
+    void update_events(FLEET_HOST& host);
+    void handle_events(FLEET_HOST& host, bool readable, bool writable, bool error, double now);
+};
+
+#endif // GUI_RPC_FLEET_H
@@ -0,0 +1,99 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Hardware performance counters of a process tree.
+
+#ifndef HW_COUNTERS_H
+#define HW_COUNTERS_H
+
+#include <vector>
+
+/// Values of the hardware counters.
+/// A counter that isn't supported by the CPU stays at zero.
+struct HW_COUNTS {
+    double instructions;
+    double cycles;
+    double llc_misses;      ///< Last-level cache misses.
+    double stalled_cycles;  ///< Cycles in which the back end was stalled.
+
+    HW_COUNTS() {
+        clear();
+    }
+    void clear();
+
+    /// Add a value read from the counter of the \a i-th member.
+    /// If the kernel had to multiplex the counter (\a time_running is
+    /// less than \a time_enabled) the value is extrapolated to the whole
+    /// time it was enabled.
+    void add_reading(int i, double value, double time_enabled, double time_running);
+
+    /// Instructions per cycle.
+    double ipc() const;
+
+    /// Last-level cache misses per 1000 instructions.
+    double llc_mpki() const;
+
+    /// Fraction of cycles that were stalled.
+    double stall_fraction() const;
+
+    HW_COUNTS& operator+=(const HW_COUNTS& other);
+    HW_COUNTS operator-(const HW_COUNTS& other) const;
+};
+
+/// Counting (not sampling) perf events attached to a process.
+///
+/// The counters are attached to each thread the process has when open()
+/// is called, and are inherited, so threads and child processes created
+/// later are included too.
+class HW_COUNTERS {
+public:
+    HW_COUNTERS();
+    ~HW_COUNTERS();
+
+    /// Start counting for the given process.
+    int open(int pid);
+    void close();
+    bool is_open() const;
+
+    /// Read the counts accumulated since open().
+    int read(HW_COUNTS& counts) const;
+
+    /// Number of descriptors open by all counters of the process.
+    static int open_fds() {
+        return nfds;
+    }
+
+private:
+    static const int NCOUNTERS = 4;
+
+    static int nfds;
+
+    /// NCOUNTERS descriptors for each thread, -1 for an event that
+    /// couldn't be opened.
+    std::vector<int> fds;
+
+    // Not copyable; the file descriptors are owned.
+    HW_COUNTERS(const HW_COUNTERS&);
+    HW_COUNTERS& operator=(const HW_COUNTERS&);
+};
+
+/// Return the value of the kernel's perf_event_paranoid setting,
+/// or -99 if it can't be read.
+int get_perf_event_paranoid();
+
+#endif // HW_COUNTERS_H
@@ -61,6 +61,12 @@ public:
         }
         return (*buf)?(*buf++):EOF;
     }
+
+    /// Return the position of the next character when reading from a
+    /// buffer, NULL otherwise.
+    const char* read_pos() const {
+        return f ? 0 : buf;
+    }
 };
 
 int copy_element_contents(MIOFILE& in, const char* end_tag, char* p, int len);
@@ -0,0 +1,130 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Lock-free queue with many producer threads and one consumer thread.
+///
+/// The queue is intrusive: items derive from MPSC_NODE, so pushing
+/// doesn't allocate. Pushing takes one atomic exchange and never waits
+/// for other threads.
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#ifdef _WIN32
+#include "boinc_win.h"
+#endif
+
+/// Link of an item in an MPSC_QUEUE.
+struct MPSC_NODE {
+    MPSC_NODE* volatile next;
+
+    MPSC_NODE(): next(0) {}
+};
+
+/// Make sure that all memory accesses before this point are done
+/// before any access after it, as seen by other threads.
+inline void mpsc_barrier() {
+#if defined(__GNUC__)
+    __sync_synchronize();
+#elif defined(_WIN32)
+    MemoryBarrier();
+#endif
+}
+
+/// Atomically store \a node in \a *ptr and return the previous value.
+inline MPSC_NODE* mpsc_exchange(MPSC_NODE* volatile* ptr, MPSC_NODE* node) {
+#if defined(__GNUC__)
+    mpsc_barrier();
+    return __sync_lock_test_and_set(ptr, node);
+#elif defined(_WIN32)
+    return static_cast<MPSC_NODE*>(InterlockedExchangePointer((PVOID volatile*)ptr, node));
+#endif
+}
+
+/// First-in first-out queue of items of type \a T, which must derive
+/// from MPSC_NODE and be allocated with new.
+///
+/// push() may be called by any thread; pop() only by one thread at a
+/// time. An item may only be in one queue at a time. Items left in the
+/// queue when it is destroyed are deleted.
+template <class T>
+class MPSC_QUEUE {
+public:
+    MPSC_QUEUE(): head(&stub), tail(&stub) {
+    }
+
+    ~MPSC_QUEUE() {
+        T* item;
+        while ((item = pop()) != 0) {
+            delete item;
+        }
+    }
+
+    void push(T* item) {
+        push_node(item);
+    }
+
+    /// Remove the oldest item and return it, or return NULL if the
+    /// queue is empty. An item whose push() hasn't returned yet may
+    /// not be seen; the producer should wake the consumer afterwards.
+    T* pop() {
+        MPSC_NODE* first = tail;
+        MPSC_NODE* next = first->next;
+        if (first == &stub) {
+            if (!next) return 0;
+            tail = next;
+            first = next;
+            next = next->next;
+        }
+        if (next) {
+            mpsc_barrier();
+            tail = next;
+            return static_cast<T*>(first);
+        }
+        if (first != head) {
+            // A producer has swapped the head but not linked it yet.
+            return 0;
+        }
+        push_node(&stub);
+        next = first->next;
+        if (next) {
+            mpsc_barrier();
+            tail = next;
+            return static_cast<T*>(first);
+        }
+        return 0;
+    }
+
+private:
+    MPSC_NODE stub;             ///< Keeps the list non-empty.
+    MPSC_NODE* volatile head;   ///< Last node pushed; changed by producers.
+    MPSC_NODE* tail;            ///< Next node to pop; only used by the consumer.
+
+    void push_node(MPSC_NODE* node) {
+        node->next = 0;
+        MPSC_NODE* prev = mpsc_exchange(&head, node);
+        mpsc_barrier();
+        prev->next = node;
+    }
+
+    // Not copyable.
+    MPSC_QUEUE(const MPSC_QUEUE&);
+    MPSC_QUEUE& operator=(const MPSC_QUEUE&);
+};
+
+#endif // MPSC_QUEUE_H
@@ -54,6 +54,21 @@ int get_socket_error(int fd);
 /// Return a string describing the current network error value.
 const char* socket_error_str();
 
+#ifndef _WIN32
+/// Make a pipe that wakes up a thread waiting in select() on its read
+/// end. Both ends don't block and aren't inherited by child processes.
+int make_wakeup_pipe(int fds[2]);
+
+/// Close both ends of a pipe made by make_wakeup_pipe() and set them to -1.
+void close_wakeup_pipe(int fds[2]);
+
+/// Make select() on the read end of a wakeup pipe return.
+void send_wakeup(int fd);
+
+/// Read all pending wakeups from the read end of a wakeup pipe.
+void drain_wakeups(int fd);
+#endif
+
 #if defined(_WIN32) && defined(USE_WINSOCK)
 typedef int boinc_socklen_t;
 #define SHUT_WR SD_SEND
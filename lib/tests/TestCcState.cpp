@@ -0,0 +1,230 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for CC_STATE in lib/gui_rpc_client.h
+
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <UnitTest++.h>
+
+#include "lib/error_numbers.h"
+#include "lib/gui_rpc_client.h"
+#include "lib/miofile.h"
+
+namespace {
+    std::string project_url(int p) {
+        std::ostringstream url;
+        url << "http://project" << p << ".example.com/";
+        return url.str();
+    }
+
+    std::string result_name(int p, int i) {
+        std::ostringstream name;
+        name << "wu_" << p << "_" << i << "_0";
+        return name.str();
+    }
+
+    /// Make the contents of a get_state reply with \a nresults results
+    /// in each of \a nprojects projects.
+    std::string make_state(int nprojects, int nresults, bool active) {
+        std::ostringstream s;
+        s << "<client_state>\n";
+        for (int p = 0; p < nprojects; ++p) {
+            s << "<project>\n"
+              << "    <master_url>" << project_url(p) << "</master_url>\n"
+              << "    <project_name>Project " << p << "</project_name>\n"
+              << "    <hostid>" << 100 + p << "</hostid>\n"
+              << "</project>\n"
+              << "<app>\n"
+              << "    <name>app</name>\n"
+              << "    <user_friendly_name>App " << p << "</user_friendly_name>\n"
+              << "</app>\n";
+            for (int v = 1; v <= 2; ++v) {
+                s << "<app_version>\n"
+                  << "    <app_name>app</app_name>\n"
+                  << "    <version_num>" << v << "</version_num>\n"
+                  << "</app_version>\n";
+            }
+            for (int i = 0; i < nresults; ++i) {
+                s << "<workunit>\n"
+                  << "    <name>wu_" << p << "_" << i << "</name>\n"
+                  << "    <app_name>app</app_name>\n"
+                  << "    <version_num>" << 1 + i % 2 << "</version_num>\n"
+                  << "</workunit>\n";
+            }
+            for (int i = 0; i < nresults; ++i) {
+                s << "<result>\n"
+                  << "    <name>" << result_name(p, i) << "</name>\n"
+                  << "    <wu_name>wu_" << p << "_" << i << "</wu_name>\n"
+                  << "    <project_url>" << project_url(p) << "</project_url>\n";
+                if (active) {
+                    s << "    <active_task>\n"
+                      << "        <fraction_done>0.5</fraction_done>\n"
+                      << "        <launch_time>0.01</launch_time>\n"
+                      << "    </active_task>\n";
+                }
+                s << "</result>\n";
+            }
+        }
+        s << "</client_state>\n";
+        return s.str();
+    }
+
+    int parse_state(CC_STATE& state, const std::string& reply) {
+        MIOFILE mf;
+        mf.init_buf_read(reply.c_str());
+        state.clear();
+        return state.parse(mf);
+    }
+}
+
+SUITE(TestCcState)
+{
+    TEST(Links)
+    {
+        CC_STATE state;
+        CHECK_EQUAL(0, parse_state(state, make_state(2, 10, false)));
+        CHECK_EQUAL(2u, state.projects.size());
+        CHECK_EQUAL(4u, state.app_versions.size());
+        CHECK_EQUAL(20u, state.results.size());
+
+        for (size_t i = 0; i < state.results.size(); ++i) {
+            RESULT* rp = state.results[i];
+            CHECK(rp->project != NULL);
+            CHECK(rp->wup != NULL);
+            CHECK(rp->app != NULL);
+            CHECK(rp->wup->avp != NULL);
+            CHECK_EQUAL(rp->project, state.lookup_project(rp->project_url));
+            CHECK_EQUAL(rp, state.lookup_result(rp->project_url, rp->name));
+            CHECK_EQUAL(rp, state.lookup_result(rp->project, rp->name));
+        }
+
+        PROJECT* p1 = state.lookup_project(project_url(1));
+        CHECK(p1 != NULL);
+        CHECK_EQUAL(101, p1->hostid);
+        APP_VERSION* avp = state.lookup_app_version(project_url(1), "app", 2);
+        CHECK(avp != NULL);
+        CHECK_EQUAL(p1, avp->project);
+        CHECK_EQUAL(state.lookup_app(p1, "app"), avp->app);
+        CHECK_EQUAL(avp, state.lookup_wu(p1, "wu_1_3")->avp);
+    }
+
+    TEST(LookupMissing)
+    {
+        CC_STATE state;
+        CHECK_EQUAL(0, parse_state(state, make_state(2, 5, false)));
+        PROJECT* p0 = state.lookup_project(project_url(0));
+
+        CHECK(state.lookup_project("http://unknown.example.com/") == NULL);
+        CHECK(state.lookup_result("http://unknown.example.com/", result_name(0, 1)) == NULL);
+        CHECK(state.lookup_result(p0, result_name(1, 1)) == NULL);
+        CHECK(state.lookup_wu(p0, "wu_0_5") == NULL);
+        CHECK(state.lookup_app_version(p0, "app", 3) == NULL);
+        CHECK(state.lookup_app(project_url(0), "other") == NULL);
+    }
+
+    TEST(ClearEmptiesIndices)
+    {
+        CC_STATE state;
+        CHECK_EQUAL(0, parse_state(state, make_state(1, 5, false)));
+        state.clear();
+        CHECK(state.results.empty());
+        CHECK(state.lookup_project(project_url(0)) == NULL);
+        CHECK(state.lookup_result(project_url(0), result_name(0, 0)) == NULL);
+    }
+
+    TEST(Unauthorized)
+    {
+        CC_STATE state;
+        CHECK_EQUAL(ERR_AUTHENTICATOR, parse_state(state, "<unauthorized/>\n"));
+    }
+
+    TEST(ReuseObjects)
+    {
+        CC_STATE state;
+        CHECK_EQUAL(0, parse_state(state, make_state(2, 50, true)));
+        std::set<RESULT*> first(state.results.begin(), state.results.end());
+        CHECK_EQUAL(0.5, state.results[0]->fraction_done);
+
+        // The second reply has fewer results; they must be cleared
+        // before being filled in again.
+        CHECK_EQUAL(0, parse_state(state, make_state(2, 40, false)));
+        CHECK_EQUAL(80u, state.results.size());
+        for (size_t i = 0; i < state.results.size(); ++i) {
+            RESULT* rp = state.results[i];
+            CHECK(first.count(rp));
+            CHECK(!rp->active_task);
+            CHECK_EQUAL(0.0, rp->fraction_done);
+            CHECK_EQUAL(0.0, rp->launch_time);
+            CHECK_EQUAL(rp, state.lookup_result(rp->project_url, rp->name));
+        }
+    }
+
+    TEST(LargeState)
+    {
+        const int NRESULTS = 10000;
+        CC_STATE state;
+        std::string reply = make_state(2, NRESULTS, true);
+        for (int pass = 0; pass < 2; ++pass) {
+            CHECK_EQUAL(0, parse_state(state, reply));
+            CHECK_EQUAL(2u * NRESULTS, state.results.size());
+        }
+        for (int p = 0; p < 2; ++p) {
+            for (int i = 0; i < NRESULTS; i += 997) {
+                RESULT* rp = state.lookup_result(project_url(p), result_name(p, i));
+                CHECK(rp != NULL);
+                if (rp) CHECK_EQUAL(result_name(p, i), rp->name);
+            }
+        }
+    }
+
+    /// Results parsed from the same XML have the same hash, any change
+    /// of the XML changes it, and results not parsed have none.
+    TEST(XmlHash)
+    {
+        const char* xml =
+            "    <name>wu_0_0_0</name>\n"
+            "    <stderr_out>\n"
+            "<![CDATA[\nline\n]]>\n"
+            "    </stderr_out>\n"
+            "    <active_task>\n"
+            "        <fraction_done>0.5</fraction_done>\n"
+            "    </active_task>\n"
+            "</result>\n";
+        std::string changed(xml);
+        changed.replace(changed.find("line"), 4, "LINE");
+
+        RESULT a, b, c, d;
+        MIOFILE in;
+        in.init_buf_read(xml);
+        CHECK_EQUAL(0, a.parse(in));
+        in.init_buf_read(xml);
+        CHECK_EQUAL(0, b.parse(in));
+        in.init_buf_read(changed.c_str());
+        CHECK_EQUAL(0, c.parse(in));
+
+        CHECK(a.xml_hash != 0);
+        CHECK_EQUAL(a.xml_hash, b.xml_hash);
+        CHECK(a.xml_hash != c.xml_hash);
+        CHECK_EQUAL(0u, d.xml_hash);
+        a.clear();
+        CHECK_EQUAL(0u, a.xml_hash);
+    }
+}
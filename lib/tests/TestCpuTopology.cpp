@@ -0,0 +1,221 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/cpu_topology.C
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "lib/cpu_topology.h"
+#include "lib/filesys.h"
+
+namespace {
+    const char* const SYSFS_ROOT = "test_sysfs";
+
+    void make_dirs(const std::string& path)
+    {
+        std::string::size_type pos = 0;
+        while ((pos = path.find('/', pos + 1)) != std::string::npos) {
+            boinc_mkdir(path.substr(0, pos).c_str());
+        }
+        boinc_mkdir(path.c_str());
+    }
+
+    void write_file(const std::string& path, const std::string& contents)
+    {
+        make_dirs(path.substr(0, path.rfind('/')));
+        FILE* f = fopen(path.c_str(), "w");
+        fputs(contents.c_str(), f);
+        fputc('\n', f);
+        fclose(f);
+    }
+
+    std::string str(int i)
+    {
+        std::ostringstream oss;
+        oss << i;
+        return oss.str();
+    }
+
+    /// Two packages with two cores of two threads each, one NUMA node and
+    /// one L3 cache per package, plus an offline CPU.
+    struct FakeSysfs {
+        CPU_TOPOLOGY topology;
+
+        FakeSysfs()
+        {
+            std::string cpu_dir = std::string(SYSFS_ROOT) + "/devices/system/cpu";
+            for (int i = 0; i < 8; ++i) {
+                std::string dir = cpu_dir + "/cpu" + str(i);
+                write_file(dir + "/topology/physical_package_id", str(i / 4));
+                write_file(dir + "/topology/core_id", str((i / 2) % 2));
+                write_file(dir + "/cache/index2/level", "2");
+                write_file(dir + "/cache/index2/shared_cpu_list", str(i & ~1) + "-" + str(i | 1));
+                write_file(dir + "/cache/index3/level", "3");
+                write_file(dir + "/cache/index3/shared_cpu_list", (i < 4) ? "0-3" : "4-7");
+                write_file(dir + "/cache/index3/size", "8192K");
+            }
+            make_dirs(cpu_dir + "/cpu8");
+            write_file(cpu_dir + "/online", "0-7");
+
+            std::string node_dir = std::string(SYSFS_ROOT) + "/devices/system/node";
+            write_file(node_dir + "/node0/cpulist", "0-3");
+            write_file(node_dir + "/node1/cpulist", "4-7");
+
+            topology.parse(SYSFS_ROOT);
+        }
+
+        ~FakeSysfs()
+        {
+            clean_out_dir(SYSFS_ROOT);
+            boinc_rmdir(SYSFS_ROOT);
+        }
+    };
+}
+
+SUITE(TestCpuTopology)
+{
+    TEST(ParseCpuList)
+    {
+        std::vector<int> cpus;
+        CHECK_EQUAL(0, parse_cpu_list("0-3,8,10-11\n", cpus));
+        CHECK_EQUAL(7u, cpus.size());
+        CHECK_EQUAL(0, cpus.front());
+        CHECK_EQUAL(8, cpus[4]);
+        CHECK_EQUAL(11, cpus.back());
+
+        CHECK(parse_cpu_list("3-1", cpus) != 0);
+        CHECK(parse_cpu_list("a", cpus) != 0);
+    }
+
+    TEST(CpuList)
+    {
+        CPU_PLACEMENT placement;
+        placement.cpus.push_back(0);
+        placement.cpus.push_back(1);
+        placement.cpus.push_back(2);
+        placement.cpus.push_back(3);
+        placement.cpus.push_back(8);
+        placement.cpus.push_back(10);
+        placement.cpus.push_back(11);
+        CHECK_EQUAL("0-3,8,10-11", placement.cpu_list());
+    }
+
+    TEST_FIXTURE(FakeSysfs, Parse)
+    {
+        CHECK_EQUAL(8u, topology.cpus.size());
+        CHECK_EQUAL(2, topology.npackages);
+        CHECK_EQUAL(4, topology.ncores);
+        CHECK_EQUAL(2, topology.nnodes);
+        CHECK_EQUAL(2, topology.nllc_domains);
+        CHECK_CLOSE(8.0 * 1024 * 1024, topology.llc_size, 1.0);
+
+        CHECK_EQUAL(topology.cpus[4].core, topology.cpus[5].core);
+        CHECK(topology.cpus[5].core != topology.cpus[6].core);
+        CHECK(topology.cpus[1].core != topology.cpus[5].core);
+        CHECK_EQUAL(1, topology.cpus[5].numa_node);
+        CHECK_EQUAL(4, topology.cpus[5].l3_domain);
+        CHECK_EQUAL(0, topology.cpus[3].l3_domain);
+    }
+
+    TEST_FIXTURE(FakeSysfs, PlaceWholeCores)
+    {
+        CPU_PLACER placer;
+        placer.init(topology);
+        CPU_PLACEMENT placement;
+
+        // One thread on each idle core of the first node.
+        CHECK(placer.place(0, 2.0, placement));
+        CHECK_EQUAL("0,2", placement.cpu_list());
+        CHECK_EQUAL(0, placement.numa_node);
+
+        // The other node still has idle cores.
+        CHECK(placer.place(1, 1.5, placement));
+        CHECK_EQUAL("4,6", placement.cpu_list());
+        CHECK_EQUAL(1, placement.numa_node);
+
+        // No idle core left, so SMT siblings are used.
+        CHECK(placer.place(2, 1.0, placement));
+        CHECK_EQUAL(1u, placement.cpus.size());
+        CHECK_EQUAL(4, placer.nfree() + 1);
+    }
+
+    TEST_FIXTURE(FakeSysfs, PlaceRelease)
+    {
+        CPU_PLACER placer;
+        placer.init(topology);
+        CPU_PLACEMENT placement;
+
+        CHECK(placer.place(0, 4.0, placement));
+        CHECK_EQUAL(4u, placement.cpus.size());
+        CHECK_EQUAL(4, placer.nfree());
+
+        // Placing the same task again replaces its old assignment.
+        CHECK(placer.place(0, 4.0, placement));
+        CHECK_EQUAL(4, placer.nfree());
+
+        CHECK(!placer.place(1, 5.0, placement));
+        CHECK(placement.empty());
+
+        placer.release(0);
+        CHECK_EQUAL(8, placer.nfree());
+
+        // A task larger than a node isn't tied to one.
+        CHECK(placer.place(1, 5.0, placement));
+        CHECK_EQUAL(5u, placement.cpus.size());
+        CHECK_EQUAL(-1, placement.numa_node);
+    }
+
+    TEST(Binding)
+    {
+        const int bits = 8 * sizeof(unsigned long);
+        CPU_PLACEMENT placement;
+        CPU_BINDING none(placement);
+        CHECK(none.cpu_mask.empty());
+        CHECK(none.node_mask.empty());
+        CHECK_EQUAL(0, none.set_affinity());
+        CHECK_EQUAL(0, none.set_numa_preference());
+
+        placement.cpus.push_back(1);
+        placement.cpus.push_back(3);
+        placement.cpus.push_back(bits + 2);
+        placement.numa_node = 1;
+        CPU_BINDING binding(placement);
+        CHECK_EQUAL(2u, binding.cpu_mask.size());
+        CHECK_EQUAL(0xaUL, binding.cpu_mask[0]);
+        CHECK_EQUAL(0x4UL, binding.cpu_mask[1]);
+        CHECK_EQUAL(1u, binding.node_mask.size());
+        CHECK_EQUAL(0x2UL, binding.node_mask[0]);
+    }
+
+    TEST(NoSysfs)
+    {
+        CPU_TOPOLOGY topology;
+        CHECK(topology.parse("nonexistent_sysfs") != 0);
+
+        CPU_PLACER placer;
+        placer.init(topology);
+        CPU_PLACEMENT placement;
+        CHECK(!placer.enabled());
+        CHECK(!placer.place(0, 1.0, placement));
+    }
+}
@@ -0,0 +1,139 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/filesys.C
+
+#include <cstdio>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <UnitTest++.h>
+
+#include "lib/filesys.h"
+
+namespace {
+    const char* SRC = "TestFilesys_src";
+    const char* DST = "TestFilesys_dst";
+
+    std::string read_file(const char* path) {
+        std::string data;
+        FILE* f = fopen(path, "rb");
+        if (!f) return data;
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            data.append(buf, n);
+        }
+        fclose(f);
+        return data;
+    }
+
+    /// Write a file larger than one copy buffer.
+    std::string write_source() {
+        std::string data;
+        for (int i = 0; i < 200000; ++i) {
+            data += char('a' + i % 26);
+        }
+        FILE* f = fopen(SRC, "wb");
+        if (f) {
+            fwrite(data.data(), 1, data.size(), f);
+            fclose(f);
+        }
+        return data;
+    }
+}
+
+SUITE(TestFilesys)
+{
+    TEST(StageCopy)
+    {
+        std::string data = write_source();
+        FILE* f = fopen(DST, "wb");
+        if (f) {
+            fputs("old contents, longer than nothing", f);
+            fclose(f);
+        }
+
+        STAGE_METHOD method;
+        CHECK_EQUAL(0, boinc_stage_file(SRC, DST, false, method));
+        CHECK(method != STAGE_LINK);
+        CHECK(read_file(DST) == data);
+
+        // The copy is a file of its own.
+        f = fopen(DST, "ab");
+        if (f) {
+            fputs("x", f);
+            fclose(f);
+        }
+        CHECK(read_file(SRC) == data);
+
+        boinc_delete_file(SRC);
+        boinc_delete_file(DST);
+    }
+
+    TEST(StageLink)
+    {
+        std::string data = write_source();
+        STAGE_METHOD method;
+        CHECK_EQUAL(0, boinc_stage_file(SRC, DST, true, method));
+        CHECK(read_file(DST) == data);
+        CHECK(stage_method_name(method) != 0);
+
+        boinc_delete_file(SRC);
+        boinc_delete_file(DST);
+    }
+
+#ifndef _WIN32
+    /// Staging again onto a hard link made earlier must not
+    /// change the source through the link.
+    TEST(StageOntoLink)
+    {
+        std::string data = write_source();
+        boinc_delete_file(DST);
+        CHECK_EQUAL(0, link(SRC, DST));
+
+        STAGE_METHOD method;
+        CHECK_EQUAL(0, boinc_stage_file(SRC, DST, true, method));
+        CHECK_EQUAL(STAGE_LINK, method);
+        CHECK(read_file(SRC) == data);
+
+        CHECK_EQUAL(0, boinc_stage_file(SRC, DST, false, method));
+        CHECK(method != STAGE_LINK);
+        CHECK(read_file(SRC) == data);
+        CHECK(read_file(DST) == data);
+
+        CHECK_EQUAL(0, boinc_stage_file(SRC, DST, false, method));
+        CHECK(read_file(SRC) == data);
+        CHECK(read_file(DST) == data);
+
+        boinc_delete_file(SRC);
+        boinc_delete_file(DST);
+    }
+#endif
+
+    TEST(StageMissingSource)
+    {
+        boinc_delete_file(SRC);
+        STAGE_METHOD method;
+        CHECK(boinc_stage_file(SRC, DST, false, method) != 0);
+        CHECK(!boinc_file_exists(DST));
+    }
+}
@@ -0,0 +1,146 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/gui_rpc_encoding.C
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+#include <UnitTest++.h>
+
+#include "lib/error_numbers.h"
+#include "lib/gui_rpc_client.h"
+#include "lib/gui_rpc_encoding.h"
+#include "lib/mfile.h"
+
+namespace {
+    std::string make_reply(int nresults) {
+        std::ostringstream s;
+        s << "<boinc_gui_rpc_reply>\n<results>\n";
+        for (int i = 0; i < nresults; ++i) {
+            s << "<result>\n    <name>wu_" << i << "_0</name>\n"
+              << "    <fraction_done>0.500000</fraction_done>\n</result>\n";
+        }
+        s << "</results>\n</boinc_gui_rpc_reply>\n\003";
+        return s.str();
+    }
+
+    /// Decode \a encoded, fed in pieces of \a step bytes.
+    int decode(const std::string& encoded, size_t step, std::string& plain, bool& done) {
+        GUI_RPC_DECODER decoder;
+        MFILE mf;
+        int retval = 0;
+        for (size_t i = 0; !retval && (i < encoded.size()); i += step) {
+            size_t n = std::min(step, encoded.size() - i);
+            retval = decoder.feed(encoded.data() + i, n, mf);
+        }
+        done = decoder.done();
+        char* buf;
+        int len;
+        mf.get_buf(buf, len);
+        plain.assign(buf ? buf : "", len);
+        free(buf);
+        return retval;
+    }
+}
+
+SUITE(TestGuiRpcEncoding)
+{
+    TEST(RoundTrip)
+    {
+        std::string reply = make_reply(1000);
+        std::string encoded;
+        CHECK_EQUAL(0, encode_gui_rpc_reply(reply, GUI_RPC_ENCODING_ZLIB, encoded));
+        CHECK_EQUAL(GUI_RPC_ENCODED_MARK, encoded[0]);
+        CHECK(encoded.size() < reply.size() / 4);
+
+        // In one piece and in pieces smaller than the header.
+        std::string plain;
+        bool done;
+        CHECK_EQUAL(0, decode(encoded, encoded.size(), plain, done));
+        CHECK(done);
+        CHECK(plain == reply);
+        CHECK_EQUAL(0, decode(encoded, 3, plain, done));
+        CHECK(done);
+        CHECK(plain == reply);
+    }
+
+    TEST(Unsupported)
+    {
+        std::string encoded;
+        CHECK(gui_rpc_encoding_supported(GUI_RPC_ENCODING_ZLIB));
+        CHECK(!gui_rpc_encoding_supported("gzip"));
+        CHECK_EQUAL(ERR_INVALID_PARAM, encode_gui_rpc_reply("<a/>", "gzip", encoded));
+    }
+
+    TEST(BadData)
+    {
+        std::string plain;
+        bool done;
+        CHECK_EQUAL(ERR_DECOMPRESS, decode("\002gzip 10\n0123456789", 100, plain, done));
+        CHECK_EQUAL(ERR_DECOMPRESS, decode("\002zlib -1\n", 100, plain, done));
+        CHECK_EQUAL(ERR_DECOMPRESS, decode("\002zlib 10\n0123456789", 100, plain, done));
+
+        // The header claims more data than the zlib stream has.
+        std::string encoded;
+        CHECK_EQUAL(0, encode_gui_rpc_reply(make_reply(10), GUI_RPC_ENCODING_ZLIB, encoded));
+        std::string::size_type eol = encoded.find('\n');
+        std::ostringstream longer;
+        longer << GUI_RPC_ENCODED_MARK << "zlib " << (encoded.size() - eol) << "\n"
+               << encoded.substr(eol + 1) << "x";
+        CHECK_EQUAL(ERR_DECOMPRESS, decode(longer.str(), 100, plain, done));
+
+        // Incomplete, but valid so far.
+        CHECK_EQUAL(0, decode(encoded.substr(0, encoded.size() - 5), 100, plain, done));
+        CHECK(!done);
+    }
+
+#ifndef _WIN32
+    TEST(GetReply)
+    {
+        int fds[2];
+        CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        RPC_CLIENT rpc;
+        rpc.sock = fds[0];
+
+        std::string reply = make_reply(200);
+        std::string encoded;
+        CHECK_EQUAL(0, encode_gui_rpc_reply(reply, GUI_RPC_ENCODING_ZLIB, encoded));
+        CHECK_EQUAL((ssize_t)encoded.size(), write(fds[1], encoded.data(), encoded.size()));
+        char* mbuf = 0;
+        CHECK_EQUAL(0, rpc.get_reply(mbuf));
+        CHECK(mbuf && (reply == mbuf));
+        free(mbuf);
+
+        // Plain replies still work on the same connection.
+        CHECK_EQUAL((ssize_t)reply.size(), write(fds[1], reply.data(), reply.size()));
+        mbuf = 0;
+        CHECK_EQUAL(0, rpc.get_reply(mbuf));
+        CHECK(mbuf && (reply == mbuf));
+        free(mbuf);
+        close(fds[1]);
+    }
+#endif
+}
@@ -0,0 +1,114 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/hw_counters.C and the parsing of get_hw_counters
+/// replies in lib/gui_rpc_client_ops.C
+
+#include <string>
+
+#include <UnitTest++.h>
+
+#include "lib/gui_rpc_client.h"
+#include "lib/hw_counters.h"
+#include "lib/miofile.h"
+
+SUITE(TestHwCounters)
+{
+    /// Readings of the same counter in several threads add up.
+    TEST(AddReadings)
+    {
+        HW_COUNTS counts;
+        counts.add_reading(0, 3000, 10, 10);
+        counts.add_reading(1, 2000, 10, 10);
+        counts.add_reading(2, 6, 10, 10);
+        counts.add_reading(0, 1000, 5, 5);
+        counts.add_reading(1, 2000, 5, 5);
+        CHECK_CLOSE(4000, counts.instructions, 0.001);
+        CHECK_CLOSE(4000, counts.cycles, 0.001);
+        CHECK_CLOSE(6, counts.llc_misses, 0.001);
+        CHECK_CLOSE(0, counts.stalled_cycles, 0.001);
+        CHECK_CLOSE(1.0, counts.ipc(), 0.001);
+        CHECK_CLOSE(1.5, counts.llc_mpki(), 0.001);
+    }
+
+    /// A multiplexed counter is extrapolated to the time it was enabled.
+    TEST(Multiplexed)
+    {
+        HW_COUNTS counts;
+        counts.add_reading(3, 100, 10, 4);
+        CHECK_CLOSE(250, counts.stalled_cycles, 0.001);
+
+        // Never scaled down, and not at all if it never ran.
+        counts.add_reading(3, 100, 10, 20);
+        counts.add_reading(3, 100, 10, 0);
+        CHECK_CLOSE(450, counts.stalled_cycles, 0.001);
+    }
+
+    TEST(Interval)
+    {
+        HW_COUNTS last;
+        last.add_reading(0, 1000, 1, 1);
+        last.add_reading(1, 1000, 1, 1);
+        HW_COUNTS now = last;
+        now.add_reading(0, 3000, 1, 1);
+        now.add_reading(1, 1000, 1, 1);
+        now.add_reading(3, 250, 1, 1);
+
+        HW_COUNTS interval = now - last;
+        CHECK_CLOSE(3.0, interval.ipc(), 0.001);
+        CHECK_CLOSE(0.25, interval.stall_fraction(), 0.001);
+
+        HW_COUNTS total = last;
+        total += interval;
+        CHECK_CLOSE(now.instructions, total.instructions, 0.001);
+        CHECK_CLOSE(now.stalled_cycles, total.stalled_cycles, 0.001);
+    }
+
+    TEST(ParseTask)
+    {
+        std::string xml =
+            "    <name>wu_1_0</name>\n"
+            "    <project_url>http://example.com/</project_url>\n"
+            "    <instructions>4000000.000000</instructions>\n"
+            "    <cycles>2000000.000000</cycles>\n"
+            "    <llc_misses>12000.000000</llc_misses>\n"
+            "    <stalled_cycles>500000.000000</stalled_cycles>\n"
+            "    <ipc>2.000000</ipc>\n"
+            "    <llc_mpki>3.000000</llc_mpki>\n"
+            "    <stall_fraction>0.250000</stall_fraction>\n"
+            "</task>\n";
+        MIOFILE in;
+        in.init_buf_read(xml.c_str());
+        TASK_HW_COUNTERS task;
+        CHECK_EQUAL(0, task.parse(in));
+        CHECK_EQUAL("wu_1_0", task.name);
+        CHECK_EQUAL("http://example.com/", task.project_url);
+        CHECK_CLOSE(4e6, task.instructions, 0.001);
+        CHECK_CLOSE(2e6, task.cycles, 0.001);
+        CHECK_CLOSE(12000, task.llc_misses, 0.001);
+        CHECK_CLOSE(5e5, task.stalled_cycles, 0.001);
+        CHECK_CLOSE(2.0, task.ipc, 0.001);
+        CHECK_CLOSE(3.0, task.llc_mpki, 0.001);
+        CHECK_CLOSE(0.25, task.stall_fraction, 0.001);
+
+        // Without the end tag.
+        MIOFILE truncated;
+        truncated.init_buf_read("<name>wu_1_0</name>\n");
+        CHECK(task.parse(truncated) != 0);
+    }
+}
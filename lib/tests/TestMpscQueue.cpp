@@ -0,0 +1,135 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/mpsc_queue.h
+
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include <UnitTest++.h>
+
+#include "lib/mpsc_queue.h"
+
+namespace {
+    struct ITEM: public MPSC_NODE {
+        int producer;
+        int value;
+
+        ITEM(int producer, int value): producer(producer), value(value) {}
+    };
+
+    const int NPRODUCERS = 4;
+    const int NITEMS = 20000;
+
+#ifndef _WIN32
+    struct PRODUCER {
+        MPSC_QUEUE<ITEM>* queue;
+        int id;
+    };
+
+    void* produce(void* arg) {
+        PRODUCER* p = static_cast<PRODUCER*>(arg);
+        for (int i = 0; i < NITEMS; ++i) {
+            p->queue->push(new ITEM(p->id, i));
+        }
+        return 0;
+    }
+#endif
+}
+
+SUITE(TestMpscQueue)
+{
+    TEST(Empty)
+    {
+        MPSC_QUEUE<ITEM> queue;
+        CHECK(queue.pop() == 0);
+    }
+
+    TEST(Order)
+    {
+        MPSC_QUEUE<ITEM> queue;
+        for (int i = 0; i < 3; ++i) {
+            queue.push(new ITEM(0, i));
+        }
+        for (int i = 0; i < 3; ++i) {
+            ITEM* item = queue.pop();
+            CHECK(item != 0);
+            if (!item) return;
+            CHECK_EQUAL(i, item->value);
+            delete item;
+        }
+        CHECK(queue.pop() == 0);
+
+        // The queue keeps working after it was empty.
+        queue.push(new ITEM(0, 3));
+        ITEM* item = queue.pop();
+        CHECK(item != 0);
+        if (!item) return;
+        CHECK_EQUAL(3, item->value);
+        delete item;
+        CHECK(queue.pop() == 0);
+    }
+
+    TEST(DeleteLeftItems)
+    {
+        MPSC_QUEUE<ITEM>* queue = new MPSC_QUEUE<ITEM>;
+        queue->push(new ITEM(0, 0));
+        queue->push(new ITEM(0, 1));
+        delete queue;
+    }
+
+#ifndef _WIN32
+    TEST(ManyProducers)
+    {
+        MPSC_QUEUE<ITEM> queue;
+        PRODUCER producers[NPRODUCERS];
+        pthread_t threads[NPRODUCERS];
+        for (int i = 0; i < NPRODUCERS; ++i) {
+            producers[i].queue = &queue;
+            producers[i].id = i;
+            pthread_create(&threads[i], 0, produce, &producers[i]);
+        }
+
+        // Every item arrives exactly once, in the order of its producer.
+        std::vector<int> next(NPRODUCERS, 0);
+        int received = 0;
+        bool in_order = true;
+        while (received < NPRODUCERS*NITEMS) {
+            ITEM* item = queue.pop();
+            if (!item) continue;
+            if (item->value != next[item->producer]) {
+                in_order = false;
+            }
+            next[item->producer] = item->value + 1;
+            received++;
+            delete item;
+        }
+        for (int i = 0; i < NPRODUCERS; ++i) {
+            pthread_join(threads[i], 0);
+        }
+        CHECK(in_order);
+        CHECK(queue.pop() == 0);
+        for (int i = 0; i < NPRODUCERS; ++i) {
+            CHECK_EQUAL(NITEMS, next[i]);
+        }
+    }
+#endif
+}
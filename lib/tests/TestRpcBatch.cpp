@@ -0,0 +1,194 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for the batch operations of lib/gui_rpc_client_ops.C
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+#include <UnitTest++.h>
+
+#include "lib/error_numbers.h"
+#include "lib/gui_rpc_client.h"
+
+#ifndef _WIN32
+namespace {
+    /// An RPC_CLIENT connected to a socket pair, with a thread on the
+    /// other end that answers each request with the next reply given to
+    /// reply(), and keeps the requests. All replies must be given before
+    /// the first RPC.
+    struct BatchFixture {
+        int fds[2];
+        RPC_CLIENT rpc;
+        std::vector<std::string> replies;
+        std::string sent;
+        pthread_t thread;
+        bool running;
+
+        BatchFixture(): running(false) {
+            socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+            rpc.sock = fds[0];
+        }
+
+        ~BatchFixture() {
+            requests();
+            ::close(fds[1]);
+        }
+
+        void reply(const std::string& body) {
+            replies.push_back("<boinc_gui_rpc_reply>\n" + body + "</boinc_gui_rpc_reply>\n\003");
+            if (!running) {
+                running = true;
+                pthread_create(&thread, 0, run, this);
+            }
+        }
+
+        /// Everything the client sent.
+        std::string requests() {
+            if (running) {
+                ::shutdown(fds[0], SHUT_WR);
+                pthread_join(thread, 0);
+                running = false;
+            }
+            return sent;
+        }
+
+        static void* run(void* arg) {
+            BatchFixture* f = static_cast<BatchFixture*>(arg);
+            size_t next = 0;
+            size_t done = 0;
+            char buf[4096];
+            ssize_t n;
+            while ((n = read(f->fds[1], buf, sizeof(buf))) > 0) {
+                f->sent.append(buf, n);
+                std::string::size_type end;
+                while (((end = f->sent.find('\003', done)) != std::string::npos) && (next < f->replies.size())) {
+                    write(f->fds[1], f->replies[next].data(), f->replies[next].size());
+                    ++next;
+                    done = end + 1;
+                }
+            }
+            return 0;
+        }
+    };
+
+    size_t count(const std::string& s, const char* what) {
+        size_t n = 0;
+        for (std::string::size_type i = s.find(what); i != std::string::npos; i = s.find(what, i + 1)) {
+            ++n;
+        }
+        return n;
+    }
+}
+
+SUITE(TestRpcBatch)
+{
+    TEST_FIXTURE(BatchFixture, Batch)
+    {
+        RESULT r1, r2;
+        r1.project_url = r2.project_url = "http://example.com/";
+        r1.name = "r1";
+        r2.name = "r2";
+        PROJECT p;
+        p.master_url = "http://example.com/";
+
+        RPC_BATCH batch;
+        CHECK_EQUAL(0, batch.result_op(r1, "suspend"));
+        CHECK_EQUAL(0, batch.result_op(r2, "suspend"));
+        CHECK_EQUAL(0, batch.project_op(p, "nomorework"));
+        CHECK_EQUAL(-1, batch.result_op(r1, "frobnicate"));
+        CHECK_EQUAL(3u, batch.size());
+        CHECK(r1.suspended_via_gui && r2.suspended_via_gui && p.dont_request_more_work);
+
+        reply("<batch_reply>\n</batch_reply>\n");
+        reply("<batch_reply>\n"
+              "<op_reply>\n<success/>\n</op_reply>\n"
+              "<op_reply>\n<error>no such result</error>\n</op_reply>\n"
+              "<op_reply>\n<success/>\n</op_reply>\n"
+              "</batch_reply>\n");
+        reply("<batch_reply>\n<op_reply>\n<success/>\n</op_reply>\n</batch_reply>\n");
+        CHECK_EQUAL(0, rpc.do_batch(batch));
+        CHECK_EQUAL(1, rpc.batch_support);
+        CHECK_EQUAL(3u, batch.retvals.size());
+        CHECK_EQUAL(0, batch.retvals[0]);
+        CHECK_EQUAL(ERR_NOT_FOUND, batch.retvals[1]);
+        CHECK_EQUAL(0, batch.retvals[2]);
+
+        // The second batch is sent without asking again.
+        batch.clear();
+        CHECK_EQUAL(0, batch.result_op(r1, "resume"));
+        CHECK_EQUAL(0, rpc.do_batch(batch));
+        CHECK_EQUAL(1u, batch.retvals.size());
+
+        std::string sent = requests();
+        CHECK_EQUAL(3u, count(sent, "<batch>"));
+        CHECK_EQUAL(2u, count(sent, "<suspend_result>"));
+        CHECK_EQUAL(1u, count(sent, "<project_nomorework>"));
+        CHECK_EQUAL(1u, count(sent, "<resume_result>"));
+    }
+
+    TEST_FIXTURE(BatchFixture, OldCoreClient)
+    {
+        RESULT r1, r2;
+        r1.name = "r1";
+        r2.name = "r2";
+        RPC_BATCH batch;
+        batch.result_op(r1, "abort");
+        batch.result_op(r2, "abort");
+
+        // Without batches, the operations are sent one by one.
+        reply("<error>unrecognized op</error>\n");
+        reply("<success/>\n");
+        reply("<error>no such result</error>\n");
+        CHECK_EQUAL(0, rpc.do_batch(batch));
+        CHECK_EQUAL(0, rpc.batch_support);
+        CHECK_EQUAL(2u, batch.retvals.size());
+        CHECK_EQUAL(0, batch.retvals[0]);
+        CHECK_EQUAL(ERR_NOT_FOUND, batch.retvals[1]);
+
+        std::string sent = requests();
+        CHECK_EQUAL(1u, count(sent, "<batch>"));
+        CHECK_EQUAL(2u, count(sent, "<abort_result>"));
+    }
+
+    TEST_FIXTURE(BatchFixture, BadReply)
+    {
+        RESULT r;
+        RPC_BATCH batch;
+        batch.result_op(r, "abort");
+        batch.result_op(r, "abort");
+
+        reply("<unauthorized/>\n");
+        reply("<batch_reply>\n</batch_reply>\n");
+        reply("<batch_reply>\n<op_reply>\n<success/>\n</op_reply>\n</batch_reply>\n");
+        CHECK_EQUAL(ERR_AUTHENTICATOR, rpc.do_batch(batch));
+        CHECK_EQUAL(-1, rpc.batch_support);
+
+        // One reply for two operations.
+        CHECK_EQUAL(ERR_XML_PARSE, rpc.do_batch(batch));
+        CHECK(batch.retvals.empty());
+    }
+}
+#endif
@@ -0,0 +1,238 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/gui_rpc_fleet.C
+
+#ifndef _WIN32
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <UnitTest++.h>
+
+#include "lib/error_numbers.h"
+#include "lib/gui_rpc_fleet.h"
+#include "lib/md5_file.h"
+#include "lib/util.h"
+
+namespace {
+    /// Serves one connection on a port of the loopback interface.
+    /// Answers get_cc_status and the authorization requests, or nothing
+    /// if #silent is set.
+    struct STAND_IN {
+        int listen_fd;
+        int port;
+        std::string password;
+        bool silent;
+        pthread_t thread;
+
+        STAND_IN(const std::string& passwd, bool no_reply = false)
+            : port(0), password(passwd), silent(no_reply)
+        {
+            listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(addr);
+            bind(listen_fd, (sockaddr*)&addr, sizeof(addr));
+            listen(listen_fd, 1);
+            getsockname(listen_fd, (sockaddr*)&addr, &len);
+            port = ntohs(addr.sin_port);
+            pthread_create(&thread, 0, run, this);
+        }
+
+        ~STAND_IN() {
+            pthread_join(thread, 0);
+            close(listen_fd);
+        }
+
+        std::string reply(const std::string& request) const {
+            std::string r("<boinc_gui_rpc_reply>\n");
+            if (request.find("<auth1/>") != std::string::npos) {
+                r += "<nonce>1234.5</nonce>\n";
+            } else if (request.find("<auth2>") != std::string::npos) {
+                std::string hash = md5_string(std::string("1234.5") + password);
+                if (request.find(hash) != std::string::npos) {
+                    r += "<authorized/>\n";
+                } else {
+                    r += "<unauthorized/>\n";
+                }
+            } else {
+                r += "<cc_status>\n<network_status>2</network_status>\n</cc_status>\n";
+            }
+            return r + "</boinc_gui_rpc_reply>\n\003";
+        }
+
+        /// Runs until the connection is closed by the other side.
+        static void* run(void* arg) {
+            STAND_IN* s = static_cast<STAND_IN*>(arg);
+            int fd = accept(s->listen_fd, 0, 0);
+            if (fd < 0) return 0;
+            std::string in;
+            char buf[1024];
+            ssize_t n;
+            while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+                in.append(buf, n);
+                std::string::size_type end;
+                while (!s->silent && ((end = in.find('\003')) != std::string::npos)) {
+                    std::string r = s->reply(in.substr(0, end));
+                    send(fd, r.data(), r.size(), 0);
+                    in.erase(0, end + 1);
+                }
+            }
+            close(fd);
+            return 0;
+        }
+    };
+
+    struct STATUS_RPC: public FLEET_RPC {
+        std::vector<int>& results;
+        CC_STATUS status;
+
+        STATUS_RPC(std::vector<int>& r): results(r) {}
+
+        const char* request() const { return "<get_cc_status/>\n"; }
+        int parse(MIOFILE& fin) { return parse_cc_status_reply(fin, status); }
+        void done(FLEET_HOST&, int retval) {
+            results.push_back(retval ? retval : status.network_status);
+        }
+    };
+
+    /// Poll \a fleet until \a results has \a n entries or 5 seconds passed.
+    void poll_for(RPC_FLEET& fleet, const std::vector<int>& results, size_t n) {
+        double end = dtime() + 5;
+        while ((results.size() < n) && (dtime() < end)) {
+            fleet.poll(0.1);
+        }
+    }
+
+    /// Return a port of the loopback interface on which nobody listens.
+    int unused_port() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        bind(fd, (sockaddr*)&addr, sizeof(addr));
+        getsockname(fd, (sockaddr*)&addr, &len);
+        close(fd);
+        return ntohs(addr.sin_port);
+    }
+}
+
+SUITE(TestRpcFleet)
+{
+    TEST(Replies)
+    {
+        STAND_IN server("");
+        std::vector<int> results;
+        {
+            RPC_FLEET fleet(5);
+            CHECK_EQUAL(0, fleet.init());
+            FLEET_HOST* host = fleet.add_host("127.0.0.1", server.port, "");
+            fleet.submit(host, new STATUS_RPC(results));
+            fleet.submit(host, new STATUS_RPC(results));
+            CHECK_EQUAL(2u, host->pending());
+            poll_for(fleet, results, 2);
+            CHECK_EQUAL(2u, results.size());
+            CHECK_EQUAL(2, results[0]);
+            CHECK_EQUAL(2, results[1]);
+            CHECK_EQUAL(FLEET_READY, host->get_state());
+            CHECK_EQUAL(0u, host->pending());
+            CHECK_EQUAL(1, host->nconnects);
+            CHECK_EQUAL(2, host->nreplies);
+        }
+    }
+
+    TEST(Authorization)
+    {
+        STAND_IN server("secret");
+        std::vector<int> results;
+        {
+            RPC_FLEET fleet(5);
+            CHECK_EQUAL(0, fleet.init());
+            FLEET_HOST* host = fleet.add_host("127.0.0.1", server.port, "secret");
+            fleet.submit(host, new STATUS_RPC(results));
+            poll_for(fleet, results, 1);
+            CHECK_EQUAL(1u, results.size());
+            CHECK_EQUAL(2, results[0]);
+        }
+    }
+
+    TEST(WrongPassword)
+    {
+        STAND_IN server("secret");
+        std::vector<int> results;
+        {
+            RPC_FLEET fleet(5);
+            CHECK_EQUAL(0, fleet.init());
+            FLEET_HOST* host = fleet.add_host("127.0.0.1", server.port, "wrong");
+            fleet.submit(host, new STATUS_RPC(results));
+            poll_for(fleet, results, 1);
+            CHECK_EQUAL(1u, results.size());
+            CHECK_EQUAL(ERR_AUTHENTICATOR, results[0]);
+            CHECK_EQUAL(FLEET_WAITING, host->get_state());
+            CHECK_EQUAL(0, host->nconnects);
+        }
+    }
+
+    TEST(Backoff)
+    {
+        std::vector<int> results;
+        RPC_FLEET fleet(5, 0.2, 0.4);
+        CHECK_EQUAL(0, fleet.init());
+        FLEET_HOST* host = fleet.add_host("127.0.0.1", unused_port(), "");
+        fleet.submit(host, new STATUS_RPC(results));
+        poll_for(fleet, results, 1);
+        CHECK_EQUAL(1u, results.size());
+        CHECK_EQUAL(ERR_CONNECT, results[0]);
+        CHECK_EQUAL(FLEET_WAITING, host->get_state());
+        CHECK_EQUAL(ERR_CONNECT, host->last_error);
+
+        // The next attempt waits for the backoff.
+        fleet.poll(0);
+        CHECK_EQUAL(FLEET_WAITING, host->get_state());
+    }
+
+    TEST(Timeout)
+    {
+        STAND_IN server("", true);
+        std::vector<int> results;
+        {
+            RPC_FLEET fleet(0.2);
+            CHECK_EQUAL(0, fleet.init());
+            FLEET_HOST* host = fleet.add_host("127.0.0.1", server.port, "");
+            fleet.submit(host, new STATUS_RPC(results));
+            poll_for(fleet, results, 1);
+            CHECK_EQUAL(1u, results.size());
+            CHECK_EQUAL(ERR_TIMEOUT, results[0]);
+            CHECK_EQUAL(ERR_TIMEOUT, host->last_error);
+            CHECK_EQUAL(1, host->nerrors);
+        }
+    }
+}
+
+#endif // !_WIN32
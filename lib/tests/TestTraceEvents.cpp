@@ -0,0 +1,117 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/trace_events.C
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "lib/trace_events.h"
+
+namespace {
+    std::string write_json()
+    {
+        FILE* f = tmpfile();
+        trace_write_json(f);
+        rewind(f);
+        std::string json;
+        char buf[256];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            json.append(buf, n);
+        }
+        fclose(f);
+        return json;
+    }
+}
+
+SUITE(TestTraceEvents)
+{
+    TEST(BufferOrder)
+    {
+        TRACE_BUFFER buf(1, 8);
+        buf.record('B', "a");
+        buf.record('E', "a");
+        buf.record('b', "b", 42);
+
+        std::vector<TRACE_EVENT> events;
+        buf.get_events(events);
+        CHECK_EQUAL(3u, events.size());
+        CHECK_EQUAL('B', events[0].phase);
+        CHECK_EQUAL("b", events[2].name);
+        CHECK_EQUAL(42ul, events[2].id);
+        CHECK(events[0].time <= events[2].time);
+    }
+
+    TEST(BufferWrap)
+    {
+        TRACE_BUFFER buf(1, 4);
+        const char* names[] = {"0", "1", "2", "3", "4", "5"};
+        for (int i = 0; i < 6; ++i) {
+            buf.record('B', names[i]);
+        }
+
+        // Only the newest events are kept.
+        std::vector<TRACE_EVENT> events;
+        buf.get_events(events);
+        CHECK_EQUAL(4u, events.size());
+        CHECK_EQUAL("2", events[0].name);
+        CHECK_EQUAL("5", events[3].name);
+    }
+
+    TEST(Intern)
+    {
+        std::string name("rpc get_state");
+        const char* p = trace_intern(name);
+        name = "changed";
+        CHECK_EQUAL("rpc get_state", p);
+        CHECK(p == trace_intern("rpc get_state"));
+    }
+
+    TEST(WriteJson)
+    {
+        trace_set_thread_name("test \"thread\"");
+        {
+            TRACE_SCOPE trace("test_scope");
+        }
+        int op;
+        trace_async_begin("test_async", &op);
+        trace_async_end("test_async", &op);
+
+        std::string json = write_json();
+        CHECK_EQUAL(0u, json.find("{\"traceEvents\":["));
+        CHECK(json.find("\"args\":{\"name\":\"test \\\"thread\\\"\"}") != std::string::npos);
+        CHECK(json.find("\"name\":\"test_scope\",\"cat\":\"synecdoche\",\"ph\":\"B\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"test_scope\",\"cat\":\"synecdoche\",\"ph\":\"E\"") != std::string::npos);
+        CHECK(json.find("\"ph\":\"b\"") != std::string::npos);
+        CHECK(json.find("\"id\":\"0x") != std::string::npos);
+    }
+
+    TEST(Disable)
+    {
+        trace_enable(false);
+        trace_begin("test_disabled");
+        trace_end("test_disabled");
+        trace_enable(true);
+        CHECK(trace_enabled());
+        CHECK_EQUAL(std::string::npos, write_json().find("test_disabled"));
+    }
+}
@@ -0,0 +1,123 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Unit tests for lib/xml_tree.C
+
+#include <sstream>
+#include <string>
+
+#include <UnitTest++.h>
+
+#include "lib/error_numbers.h"
+#include "lib/xml_tree.h"
+
+namespace {
+    const char* RESULTS_REPLY =
+        "<boinc_gui_rpc_reply>\n"
+        "<results>\n"
+        "<result>\n"
+        "    <name>wu_1_0</name>\n"
+        "    <fraction_done>0.250000</fraction_done>\n"
+        "    <suspended_via_gui/>\n"
+        "</result>\n"
+        "<result>\n"
+        "    <name>wu_2_0</name>\n"
+        "    <fraction_done>0.500000</fraction_done>\n"
+        "</result>\n"
+        "</results>\n"
+        "</boinc_gui_rpc_reply>\n";
+}
+
+SUITE(TestXmlTree)
+{
+    TEST(Parse)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(0, parse_xml_tree(RESULTS_REPLY, root));
+        const XML_NODE* reply = root.child("boinc_gui_rpc_reply");
+        CHECK(reply != NULL);
+        const XML_NODE* results = reply->child("results");
+        CHECK(results != NULL);
+        CHECK_EQUAL(2u, results->children.size());
+        CHECK_EQUAL("wu_1_0", results->children[0].child("name")->text);
+        CHECK_EQUAL("", results->children[0].child("suspended_via_gui")->text);
+        CHECK(results->children[1].child("suspended_via_gui") == NULL);
+    }
+
+    TEST(ParseText)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(0, parse_xml_tree("<?xml version=\"1.0\"?>\n"
+            "<msg seqno=\"1\"><!-- comment --><body>\n"
+            "a &lt; b &amp;&amp; <![CDATA[c < d]]>\n</body></msg>", root));
+        CHECK_EQUAL(1u, root.children.size());
+        CHECK_EQUAL("msg", root.children[0].name);
+        CHECK_EQUAL("a < b && c < d", root.children[0].child("body")->text);
+    }
+
+    TEST(ParseErrors)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(ERR_XML_PARSE, parse_xml_tree("<a><b></a>", root));
+        CHECK_EQUAL(ERR_XML_PARSE, parse_xml_tree("<a>", root));
+        CHECK_EQUAL(ERR_XML_PARSE, parse_xml_tree("</a>", root));
+        CHECK_EQUAL(ERR_XML_PARSE, parse_xml_tree("<a", root));
+    }
+
+    TEST(Json)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(0, parse_xml_tree(RESULTS_REPLY, root));
+        std::ostringstream out;
+        write_json_tree(out, *root.child("boinc_gui_rpc_reply"));
+        CHECK_EQUAL("{\"results\":[{\"result\":["
+            "{\"name\":\"wu_1_0\",\"fraction_done\":\"0.250000\",\"suspended_via_gui\":\"\"},"
+            "{\"name\":\"wu_2_0\",\"fraction_done\":\"0.500000\"}]}]}", out.str());
+
+        std::ostringstream s;
+        write_json_string(s, "a\"b\\c\n");
+        CHECK_EQUAL("\"a\\\"b\\\\c\\u000a\"", s.str());
+    }
+
+    TEST(Flatten)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(0, parse_xml_tree(RESULTS_REPLY, root));
+        XML_FIELDS fields;
+        flatten_xml_tree(*root.child("boinc_gui_rpc_reply"), fields);
+        CHECK_EQUAL(5u, fields.size());
+        CHECK_EQUAL("0.250000", fields["results/result[wu_1_0]/fraction_done"]);
+        CHECK_EQUAL("0.500000", fields["results/result[wu_2_0]/fraction_done"]);
+        CHECK(fields.count("results/result[wu_1_0]/suspended_via_gui"));
+    }
+
+    TEST(FlattenWithoutKeys)
+    {
+        XML_NODE root;
+        CHECK_EQUAL(0, parse_xml_tree(
+            "<list><item><v>1</v></item><item><v>2</v></item>"
+            "<tag>x</tag><tag>y</tag><one><v>3</v></one></list>", root));
+        XML_FIELDS fields;
+        flatten_xml_tree(root, fields);
+        CHECK_EQUAL(5u, fields.size());
+        CHECK_EQUAL("1", fields["list/item[0]/v"]);
+        CHECK_EQUAL("2", fields["list/item[1]/v"]);
+        CHECK_EQUAL("y", fields["list/tag[1]"]);
+        CHECK_EQUAL("3", fields["list/one/v"]);
+    }
+}
@@ -0,0 +1,111 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// Recorder for timestamped trace events, written out in the Chrome
+/// trace-event JSON format (load it in chrome://tracing).
+///
+/// Every thread records into its own ring buffer, so recording doesn't
+/// take any locks. Only the most recent events of each thread are kept.
+
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Number of events kept for each thread.
+#define TRACE_BUFFER_SIZE 16384
+
+/// A single trace event.
+struct TRACE_EVENT {
+    double time;        ///< dtime() when the event was recorded.
+    const char* name;   ///< Must stay valid; use a literal or trace_intern().
+    unsigned long id;   ///< Identifies the operation of asynchronous events.
+    char phase;         ///< Chrome phase: 'B'/'E' begin/end, 'b'/'e' async begin/end.
+};
+
+/// Ring buffer of the events of one thread.
+///
+/// Only the owning thread may call record(). Other threads may call
+/// get_events() at any time: every slot carries the sequence number of
+/// the event in it, which is odd while the event is being written, so
+/// events that are overwritten while they are being copied are dropped.
+class TRACE_BUFFER {
+public:
+    TRACE_BUFFER(int tid, size_t size = TRACE_BUFFER_SIZE);
+
+    void record(char phase, const char* name, unsigned long id = 0);
+
+    /// Copy the events currently in the buffer, oldest first.
+    void get_events(std::vector<TRACE_EVENT>& out) const;
+
+    int tid;                    ///< Small number identifying the thread.
+    std::string thread_name;
+
+private:
+    struct SLOT {
+        /// 2*n+1 while event n is written into the slot, 2*n+2 after that.
+        volatile unsigned long seq;
+        TRACE_EVENT event;
+    };
+
+    std::vector<SLOT> slots;
+    volatile unsigned long count;   ///< Number of events recorded so far.
+};
+
+/// Turn recording on or off for all threads. It is on by default.
+void trace_enable(bool enable);
+bool trace_enabled();
+
+/// Name the calling thread in the trace.
+void trace_set_thread_name(const char* name);
+
+void trace_begin(const char* name);
+void trace_end(const char* name);
+
+/// Record the start and end of an operation that may overlap with others,
+/// e.g. a network transfer. \a id must be the same for both calls.
+void trace_async_begin(const char* name, const void* id);
+void trace_async_end(const char* name, const void* id);
+
+/// Return a copy of \a name that stays valid for the lifetime of the program.
+const char* trace_intern(const std::string& name);
+
+/// Write the events of all threads as a JSON object.
+int trace_write_json(FILE* f);
+
+/// Write the events of all threads to the file \a path.
+int trace_dump(const char* path);
+
+/// Records a begin event when constructed and an end event when destroyed.
+/// Records nothing if \a name is null.
+class TRACE_SCOPE {
+public:
+    explicit TRACE_SCOPE(const char* name): name(name) {
+        if (name) trace_begin(name);
+    }
+    ~TRACE_SCOPE() {
+        if (name) trace_end(name);
+    }
+
+private:
+    const char* name;
+};
+
+#endif // TRACE_EVENTS_H
@@ -0,0 +1,64 @@
+// This file is part of Synecdoche.
+// http://synecdoche.googlecode.com/
+// Copyright (C) 2010 Synecdoche developers
+//
+// Synecdoche is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Synecdoche is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License with Synecdoche.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \file
+/// A small in-memory tree of an XML document, as sent in GUI RPC
+/// replies, with conversions for tools that need a generic view of a
+/// reply instead of the structures in gui_rpc_client.h.
+
+#ifndef XML_TREE_H
+#define XML_TREE_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// An element of an XML document. Attributes are ignored.
+struct XML_NODE {
+    std::string name;
+    std::string text;               ///< Unescaped content of a leaf, without surrounding whitespace.
+    std::vector<XML_NODE> children;
+
+    /// Return the first child called \a child_name, or NULL.
+    const XML_NODE* child(const std::string& child_name) const;
+};
+
+/// Fields of a document by path, see flatten_xml_tree().
+typedef std::map<std::string, std::string> XML_FIELDS;
+
+/// Parse the document in \a buf. The top-level elements become the
+/// children of \a root, which has no name.
+///
+/// \return Zero on success, ERR_XML_PARSE if the tags don't match.
+int parse_xml_tree(const char* buf, XML_NODE& root);
+
+/// Write \a node as a JSON object on one line. A leaf child becomes a
+/// string, or an array of strings if there are several with the same
+/// name. Other children always become arrays of objects.
+void write_json_tree(std::ostream& out, const XML_NODE& node);
+
+/// Write \a s as a JSON string literal.
+void write_json_string(std::ostream& out, const std::string& s);
+
+/// Collect the leaves below \a node by their path, like
+/// "results/result[wu_1_0]/fraction_done". Elements are identified by
+/// their name, master_url or seqno child, or by their position among
+/// siblings of the same name if that child is missing or not unique.
+void flatten_xml_tree(const XML_NODE& node, XML_FIELDS& fields);
+
+#endif // XML_TREE_H